@@ -2,6 +2,7 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "buttonlib.h"
+#include "buttonlib_sleep.h"
 
 /*
  * Example application:
@@ -22,6 +23,8 @@
 #define ID_C   20
 #define ID_R   30
 
+#define ID_LOCK 90  // Combo ID (L + R)
+
 // --- Menu system types -------------------------------------------------------
 
 typedef enum {
@@ -224,10 +227,17 @@ static const btn_config_t cfg_c = {
     .repeat_period_ms = 0
 };
 
-static btn_instance_t buttons[3];
-static btn_state_t    states[3];
-static btn_event_t    queue[32];
-static btn_context_t  ctx;
+// Combo: emergency exit / lock (L + R held > 1s), buttons[0] and buttons[2]
+static const btn_combo_t combos[] = {
+    { .id = ID_LOCK, .members = (1u << 0) | (1u << 2), .hold_ms = 1000, .suppress = true }
+};
+
+static btn_instance_t    buttons[3];
+static btn_state_t       states[3];
+static btn_event_t       queue[16];
+static btn_combo_state_t combo_states[1];
+static btn_context_t     ctx;
+static btn_sleep_t       lp;
 
 // --- Main --------------------------------------------------------------------
 
@@ -239,34 +249,35 @@ int main(void) {
     gpio_init(PIN_C); gpio_set_dir(PIN_C, GPIO_IN); gpio_pull_up(PIN_C);
     gpio_init(PIN_R); gpio_set_dir(PIN_R, GPIO_IN); gpio_pull_up(PIN_R);
 
-    btn_init(&ctx, buttons, 3, queue, 32);
+    btn_init(&ctx, buttons, 3, queue, 16);
+    btn_set_overflow_policy(&ctx, BTN_OVERFLOW_PRIORITY, false); // Repeats go first
     btn_setup(&ctx, 0, &cfg_l, &states[0]);
     btn_setup(&ctx, 1, &cfg_c, &states[1]);
     btn_setup(&ctx, 2, &cfg_r, &states[2]);
+    btn_set_combos(&ctx, combos, combo_states, 1);
+
+    // Sleep between updates: wake on a pin edge or the next library timer
+    static const btn_sleep_pin_t sleep_pins[] = {
+        { PIN_L, ID_L }, { PIN_C, ID_C }, { PIN_R, ID_R }
+    };
+    btn_sleep_init(&lp, &ctx, sleep_pins, 3);
 
     menu_close(); // Start in dashboard mode
 
+    uint64_t now = time_us_64();
     while (true) {
-        uint64_t now = time_us_64();
         btn_update(&ctx, now);
 
-        /* Combo: emergency exit / lock (L + R held > 1s) */
-        if (btn_is_pressed(&ctx, ID_L) && btn_is_pressed(&ctx, ID_R)) {
-            if (btn_get_duration(&ctx, ID_L, now) > 1000000ULL &&
-                btn_get_duration(&ctx, ID_R, now) > 1000000ULL) {
-
-                btn_suppress_events(&ctx, ID_L);
-                btn_suppress_events(&ctx, ID_R);
+        /* Process button events */
+        btn_event_t evt;
+        while (btn_pop_event(&ctx, &evt)) {
 
+            // Combo: members are already suppressed by the library
+            if (evt.type == BTN_EVT_COMBO && evt.btn_id == ID_LOCK) {
                 menu_close();
                 printf("\n>> LOCKED / HOME <<\n");
-                sleep_ms(500);
+                continue;
             }
-        }
-
-        /* Process button events */
-        btn_event_t evt;
-        while (btn_pop_event(&ctx, &evt)) {
 
             // Dashboard mode: only CENTER long press opens menu
             if (!menu_active) {
@@ -332,6 +343,6 @@ int main(void) {
         }
 
         render();
-        sleep_ms(5);
+        now = btn_sleep_wait(&lp);
     }
 }
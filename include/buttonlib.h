@@ -24,6 +24,89 @@ extern "C" {
 #include <stdbool.h>
 #include <stddef.h>
 
+/* -------------------------------------------------------------------------- */
+/*  Build options                                                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compact per-button state (opt-in).
+ *
+ * When set to 1, btn_state_t stores wrap-safe 32-bit microsecond times and
+ * packs its flags into bit-fields, and the update hot path uses only 32-bit
+ * arithmetic. Measured size: 24 bytes per button instead of 96 (20 instead
+ * of 56 with the optional features disabled): five 32-bit times including
+ * the cached deadline, plus four bytes of flags and counters. 16-bit times
+ * would wrap after 65 ms at microsecond resolution, so they are not used.
+ *
+ * Thresholds are not cached per button; they are converted from the 16-bit
+ * btn_config_t milliseconds on use. That is one 32-bit multiply per use
+ * (single cycle on the Cortex-M0+, no 64-bit math) and saves 16 bytes per
+ * button, which would otherwise double the state.
+ *
+ * Limitation: intervals measured by the library (hold duration, timers)
+ * wrap after 2^32 us (~71.6 minutes).
+ *
+ * Must be identical for the library and all code including this header.
+ */
+#ifndef BUTTONLIB_COMPACT_STATE
+#define BUTTONLIB_COMPACT_STATE 0
+#endif
+
+/**
+ * @brief Compact event records (opt-in).
+ *
+ * When set to 1, btn_event_t is 8 bytes instead of 24: type is stored as a
+ * uint8_t and timestamp holds the low 32 bits of the microsecond clock. Use
+ * btn_event_time_us() to rebuild the full time. Cuts queue / deferred
+ * ring RAM and copies to a third; the layout has no padding holes, so
+ * records can be forwarded as-is to a little-endian host.
+ *
+ * Must be identical for the library and all code including this header.
+ */
+#ifndef BUTTONLIB_COMPACT_EVENTS
+#define BUTTONLIB_COMPACT_EVENTS 0
+#endif
+
+/**
+ * @brief State machine features (all enabled by default).
+ *
+ * Setting a flag to 0 removes the matching code from btn_update() and the
+ * matching fields from btn_state_t:
+ *  - BUTTONLIB_ENABLE_MULTICLICK: click series and click_timeout_ms. When
+ *    disabled, every short press emits BTN_EVT_CLICK (clicks = 1) on release.
+ *  - BUTTONLIB_ENABLE_LONGPRESS: BTN_EVT_LONG_START and long_press_ms. When
+ *    disabled, every press counts as short.
+ *  - BUTTONLIB_ENABLE_REPEAT: BTN_EVT_LONG_HOLD and repeat_period_ms.
+ *    Requires BUTTONLIB_ENABLE_LONGPRESS and follows it by default.
+ *  - BUTTONLIB_ENABLE_SUPPRESS: btn_suppress_events() / btn_suppress_events_idx()
+ *    and btn_combo_t::suppress (ignored when disabled).
+ *
+ * btn_config_t keeps all timing fields; timings of disabled features are
+ * ignored. Must be identical for the library and all code including this header.
+ */
+#ifndef BUTTONLIB_ENABLE_MULTICLICK
+#define BUTTONLIB_ENABLE_MULTICLICK 1
+#endif
+#ifndef BUTTONLIB_ENABLE_LONGPRESS
+#define BUTTONLIB_ENABLE_LONGPRESS 1
+#endif
+#ifndef BUTTONLIB_ENABLE_REPEAT
+#define BUTTONLIB_ENABLE_REPEAT BUTTONLIB_ENABLE_LONGPRESS
+#endif
+#ifndef BUTTONLIB_ENABLE_SUPPRESS
+#define BUTTONLIB_ENABLE_SUPPRESS 1
+#endif
+
+#if BUTTONLIB_ENABLE_REPEAT && !BUTTONLIB_ENABLE_LONGPRESS
+#error "BUTTONLIB_ENABLE_REPEAT requires BUTTONLIB_ENABLE_LONGPRESS"
+#endif
+
+#if BUTTONLIB_COMPACT_STATE
+typedef uint32_t btn_time_t;   ///< Low 32 bits of the microsecond clock
+#else
+typedef uint64_t btn_time_t;   ///< Microsecond clock
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*  Event types                                                               */
 /* -------------------------------------------------------------------------- */
@@ -34,8 +117,13 @@ typedef enum {
     BTN_EVT_CLICK,          ///< Completed click series (single / double / triple ...)
     BTN_EVT_LONG_START,     ///< Long press threshold reached (fired once per hold)
     BTN_EVT_LONG_HOLD,      ///< Auto-repeat while held
+    BTN_EVT_COMBO,          ///< Combo held long enough (btn_id = combo ID, see btn_combo_t)
+    BTN_EVT_GESTURE,        ///< Gesture sequence completed (btn_id = gesture ID, see btn_gesture_t)
 } btn_event_type_t;
 
+/** @brief Number of event types (size of per-type tables). */
+#define BTN_EVT_TYPE_COUNT (BTN_EVT_GESTURE + 1)
+
 /**
  * @brief Button event descriptor.
  *
@@ -46,25 +134,52 @@ typedef enum {
  *      moment when long-press threshold or repeat interval is reached.
  *  - BTN_EVT_CLICK:
  *      moment of the last release in the click series (not the timeout end).
+ *  - BTN_EVT_COMBO:
+ *      moment the combo hold threshold is reached.
+ *  - BTN_EVT_GESTURE:
+ *      timestamp of the event that completed the sequence.
+ *
+ * With BUTTONLIB_COMPACT_EVENTS the fields keep their names; type is a
+ * uint8_t holding a btn_event_type_t and timestamp is the low 32 bits.
  */
+#if BUTTONLIB_COMPACT_EVENTS
+typedef struct {
+    uint8_t  btn_id;            ///< Button ID (from configuration)
+    uint8_t  type;              ///< Event type (btn_event_type_t)
+    uint8_t  clicks;            ///< Click count (for CLICK) or repeat index (for LONG_HOLD)
+    uint8_t  reserved;          ///< Always 0
+    uint32_t timestamp;         ///< Low 32 bits of the event time in microseconds
+} btn_event_t;
+#else
 typedef struct {
     uint8_t          btn_id;     ///< Button ID (from configuration)
     btn_event_type_t type;       ///< Event type
     uint8_t          clicks;     ///< Click count (for CLICK) or repeat index (for LONG_HOLD)
     uint64_t         timestamp;  ///< Event time in microseconds
 } btn_event_t;
+#endif
 
 /* -------------------------------------------------------------------------- */
 /*  Callback types                                                            */
 /* -------------------------------------------------------------------------- */
 
 typedef bool (*btn_read_fn_t)(void *arg);                 ///< Hardware read callback
+typedef uint32_t (*btn_bank_read_fn_t)(void *arg);        ///< Bank read callback (e.g. gpio_get_all)
 typedef bool (*btn_cb_t)(const btn_event_t *evt, void *user_data); ///< Optional per-button callback
+typedef void (*btn_matrix_select_fn_t)(void *arg, uint8_t row);     ///< Drive one matrix row, release the others
 
 /* -------------------------------------------------------------------------- */
 /*  Configuration and state                                                   */
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Source of the raw electrical state of a button.
+ */
+typedef enum {
+    BTN_SRC_READ_FN = 0,    ///< read_fn(hw_arg) is called for this button on every update
+    BTN_SRC_BANK,           ///< One bit of a bank snapshot, read once per update for all buttons
+} btn_source_t;
+
 /**
  * @brief Button configuration.
  *
@@ -87,6 +202,11 @@ typedef struct {
     uint16_t click_timeout_ms;  ///< Time window to accumulate multi-clicks
     uint16_t long_press_ms;     ///< Long press threshold
     uint16_t repeat_period_ms;  ///< Auto-repeat period (0 disables repeat)
+
+    // Bank input (BTN_SRC_BANK only; read_fn/hw_arg are ignored)
+    btn_source_t source;     ///< BTN_SRC_READ_FN (default) or BTN_SRC_BANK
+    uint8_t      bank;       ///< Bank index (see btn_init_banks)
+    uint8_t      bank_bit;   ///< Bit in the bank snapshot (0..31), e.g. the GPIO number
 } btn_config_t;
 
 /**
@@ -96,17 +216,82 @@ typedef struct {
  * Fields are fully managed by the library.
  */
 typedef struct {
+#if BUTTONLIB_COMPACT_STATE
+    btn_time_t last_debounce_time;
+    btn_time_t state_start_time;  ///< Pressed: time of logical press; released: first raw edge
+#if BUTTONLIB_ENABLE_MULTICLICK || BUTTONLIB_ENABLE_REPEAT
+    union {
+#if BUTTONLIB_ENABLE_MULTICLICK
+        btn_time_t last_release_time; ///< Released: last logical release (for click timeout)
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
+        btn_time_t last_repeat_time;  ///< Held: last LONG_START / LONG_HOLD
+#endif
+    };
+#endif
+    btn_time_t due;               ///< Next deadline of the state machine
+
+    volatile btn_time_t edge_time;    ///< Time of the last notified raw edge
+
+    bool logic_state : 1;       ///< Debounced logical state (true = pressed)
+    bool raw_state   : 1;       ///< Raw state as read from hardware
+#if BUTTONLIB_ENABLE_SUPPRESS
+    bool suppressed  : 1;       ///< Suppression flag (for combos / chords)
+#endif
+    bool has_due     : 1;       ///< due is valid (a timer is pending)
+    bool first_edge  : 1;       ///< Released: state_start_time holds the first raw edge
+
+#if BUTTONLIB_ENABLE_MULTICLICK || BUTTONLIB_ENABLE_LONGPRESS
+    uint8_t click_count;        ///< Click accumulator or LONG_PRESS_ACTIVE marker
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
+    uint8_t hold_repeat_count;  ///< LONG_HOLD repeat counter within a single hold
+#endif
+
+    volatile bool edge_pending; ///< Set by btn_notify_edge() (IRQ side)
+
+    // No cached thresholds: they are converted from btn_config_t on use.
+#else
     bool logic_state;           ///< Debounced logical state (true = pressed)
     bool raw_state;             ///< Raw state as read from hardware
+#if BUTTONLIB_ENABLE_SUPPRESS
     bool suppressed;            ///< Suppression flag (for combos / chords)
+#endif
+    bool has_due;               ///< due is valid (a timer is pending)
+    bool first_edge;            ///< Released: state_start_time holds the first raw edge
 
-    uint64_t last_debounce_time;
-    uint64_t state_start_time;  ///< Time of logical press (for hold duration)
-    uint64_t last_release_time; ///< Time of last logical release (for click timeout)
-    uint64_t last_repeat_time;  ///< Time of last LONG_HOLD repeat
+    btn_time_t last_debounce_time;
+    btn_time_t state_start_time;  ///< Pressed: time of logical press; released: first raw edge
+#if BUTTONLIB_ENABLE_MULTICLICK
+    btn_time_t last_release_time; ///< Time of last logical release (for click timeout)
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
+    btn_time_t last_repeat_time;  ///< Time of last LONG_HOLD repeat
+#endif
+    btn_time_t due;               ///< Next deadline of the state machine
 
+#if BUTTONLIB_ENABLE_MULTICLICK || BUTTONLIB_ENABLE_LONGPRESS
     uint8_t click_count;        ///< Click accumulator or LONG_PRESS_ACTIVE marker
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
     uint8_t hold_repeat_count;  ///< LONG_HOLD repeat counter within a single hold
+#endif
+
+    volatile bool       edge_pending; ///< Set by btn_notify_edge() (IRQ side)
+    volatile btn_time_t edge_time;    ///< Time of the last notified raw edge
+
+    // Thresholds in microseconds, cached from btn_config_t by btn_setup()
+    btn_time_t debounce_us;
+#if BUTTONLIB_ENABLE_MULTICLICK
+    btn_time_t click_timeout_us;
+#endif
+#if BUTTONLIB_ENABLE_LONGPRESS
+    btn_time_t long_press_us;
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
+    btn_time_t repeat_period_us;
+#endif
+#endif
 } btn_state_t;
 
 typedef struct {
@@ -114,6 +299,239 @@ typedef struct {
     btn_state_t        *state;
 } btn_instance_t;
 
+/**
+ * @brief Combo (chord) definition.
+ *
+ * A combo fires a single BTN_EVT_COMBO once all member buttons have been
+ * logically pressed together for longer than hold_ms. It re-arms when any
+ * member is released.
+ */
+typedef struct {
+    uint8_t  id;        ///< Combo ID, reported as btn_id of BTN_EVT_COMBO
+    uint32_t members;   ///< Bit n = buttons[n] (indices 0..31)
+    uint16_t hold_ms;   ///< Hold time of the complete chord
+    bool     suppress;  ///< Suppress member events when the combo fires
+} btn_combo_t;
+
+/**
+ * @brief Runtime state of a combo (managed by the library).
+ */
+typedef struct {
+    btn_time_t since;   ///< Time all members became pressed
+    bool       active;  ///< All members currently pressed
+    bool       fired;   ///< BTN_EVT_COMBO already emitted for this activation
+} btn_combo_state_t;
+
+#ifndef BTN_GESTURE_MAX_STATES
+#define BTN_GESTURE_MAX_STATES  32  ///< Automaton states (1 + total steps of all gestures, worst case)
+#endif
+
+#ifndef BTN_GESTURE_MAX_SYMBOLS
+#define BTN_GESTURE_MAX_SYMBOLS 16  ///< Distinct steps over all gestures
+#endif
+
+#if BTN_GESTURE_MAX_STATES > 255
+#error "BTN_GESTURE_MAX_STATES must fit in uint8_t"
+#endif
+
+/**
+ * @brief One step of a gesture: an event to wait for.
+ *
+ * Matches events with the same btn_id and type. For BTN_EVT_CLICK the click
+ * count must match as well; for other types clicks is ignored (leave it 0).
+ */
+typedef struct {
+    uint8_t btn_id;     ///< Button ID (or combo ID for BTN_EVT_COMBO)
+    uint8_t type;       ///< btn_event_type_t
+    uint8_t clicks;     ///< Click count (BTN_EVT_CLICK only)
+} btn_gesture_step_t;
+
+/**
+ * @brief Gesture (event sequence) definition.
+ *
+ * Example: C double click, then L long press:
+ * { {ID_C, BTN_EVT_CLICK, 2}, {ID_L, BTN_EVT_LONG_START, 0} }.
+ */
+typedef struct {
+    uint8_t                   id;       ///< Gesture ID, reported as btn_id of BTN_EVT_GESTURE
+    const btn_gesture_step_t *steps;
+    uint8_t                   length;   ///< Number of steps (>= 1)
+} btn_gesture_t;
+
+/**
+ * @brief Gesture automaton compiled by btn_gesture_compile().
+ *
+ * A DFA over the distinct steps of all gestures (Aho-Corasick: a trie of
+ * the sequences plus fallback transitions), so each event costs one symbol
+ * lookup and one table read regardless of the number of gestures.
+ */
+typedef struct {
+    uint32_t symbols[BTN_GESTURE_MAX_SYMBOLS];  ///< Sorted step keys
+    uint8_t  symbol_count;
+    uint8_t  state_count;
+
+    uint8_t  next[BTN_GESTURE_MAX_STATES][BTN_GESTURE_MAX_SYMBOLS];
+    uint8_t  match[BTN_GESTURE_MAX_STATES];     ///< Gesture index + 1 completed in a state (0 = none)
+    uint8_t  output[BTN_GESTURE_MAX_STATES];    ///< Longest suffix state with a match (0 = none)
+    uint8_t  ids[BTN_GESTURE_MAX_STATES];       ///< Gesture ID per match index
+
+    uint8_t  state;             ///< Current state (0 = no step matched)
+    uint32_t gap_us;            ///< Max time between steps (0 = unlimited)
+    uint64_t last_us;           ///< Timestamp of the last matched step
+} btn_gesture_engine_t;
+
+/**
+ * @brief Input bank: a group of buttons sampled with a single read.
+ *
+ * The user allocates an array of banks and passes it to btn_init_banks().
+ * Masks are maintained by btn_setup() for every BTN_SRC_BANK button.
+ *
+ * Banks are scanned bit-parallel: on each update only bits that changed
+ * since the previous snapshot, or that still have a pending timer, run the
+ * per-button state machine. Idle buttons of a bank cost nothing per tick.
+ */
+typedef struct {
+    btn_bank_read_fn_t read_fn; ///< Returns the raw bank snapshot (bit n = input n)
+    void              *arg;     ///< Opaque argument passed to read_fn
+
+    uint32_t used_mask;         ///< Bits assigned to configured buttons
+    uint32_t invert_mask;       ///< Bits of active_low buttons (applied as one XOR)
+    uint32_t snapshot;          ///< Last sample in logical polarity (1 = pressed)
+    uint32_t busy_mask;         ///< Bits with pending debounce / hold / click timers
+
+    bool external;              ///< Snapshot supplied by a matrix scan, not by read_fn
+    volatile bool edge_notified;///< btn_notify_edge() on a bit since the last scan
+
+    uint8_t btn_index[32];      ///< Bit -> index in the buttons array
+} btn_bank_t;
+
+/** @brief Maximum number of rows of a key matrix. */
+#define BTN_MATRIX_MAX_ROWS 16
+
+/**
+ * @brief Key matrix scanned row by row into consecutive banks.
+ *
+ * Row r of the matrix is bank (first_bank + r); a key is configured as a
+ * BTN_SRC_BANK button with bank = first_bank + row and bank_bit = column.
+ * One scan costs `rows` select_fn calls and `rows` read_fn calls, after
+ * which every row goes through the regular bit-parallel bank scan.
+ *
+ * Polarity is a property of the matrix (active_low), the active_low flag of
+ * the key configurations is ignored.
+ *
+ * Ghosting: without diodes, three pressed keys on the corners of a rectangle
+ * make the fourth corner read as pressed. Rows that share two or more
+ * pressed columns with another row are ambiguous; new presses in them are
+ * ignored (releases still pass) until the ambiguity clears.
+ */
+typedef struct {
+    btn_matrix_select_fn_t select_fn; ///< Drive a row (and release the previous one)
+    btn_bank_read_fn_t     read_fn;   ///< Read all columns of the driven row
+    void                  *arg;       ///< Opaque argument passed to both callbacks
+
+    uint8_t  first_bank;        ///< Bank of row 0
+    uint8_t  rows;              ///< Number of rows (1 .. BTN_MATRIX_MAX_ROWS)
+    uint32_t col_mask;          ///< Columns present in read_fn results
+    bool     active_low;        ///< true if a pressed key reads as 0
+
+    uint32_t ghost_rows;        ///< Rows found ambiguous by the last scan (managed by the library)
+    size_t   ghost_scans;       ///< Number of scans that detected ghosting (managed by the library)
+} btn_matrix_t;
+
+/** @brief Number of buckets of the raw edge -> DOWN latency histogram. */
+#define BTN_LATENCY_BUCKETS 16
+
+/**
+ * @brief Free-running up-counter used to time btn_update() (e.g. time_us_32()).
+ *
+ * Differences are taken modulo 2^32, the unit is up to the application.
+ */
+typedef uint32_t (*btn_clock_fn_t)(void *arg);
+
+/**
+ * @brief Opt-in runtime statistics (see btn_set_stats() / btn_get_stats()).
+ *
+ * Written by btn_update() only; all counters saturate at their maximum.
+ */
+typedef struct {
+    uint32_t updates;           ///< Number of btn_update() calls
+    uint32_t update_max;        ///< Worst btn_update() duration (clock units, 0 without clock)
+    uint32_t update_avg;        ///< Average duration (computed by btn_get_stats())
+    uint64_t update_total;      ///< Sum of btn_update() durations (clock units)
+
+    size_t   queue_high_water;  ///< Highest event queue fill seen by the producer
+
+    uint32_t events[BTN_EVT_TYPE_COUNT]; ///< Emitted events per type (callback-consumed ones included)
+
+    uint32_t latency_bucket_us;                 ///< Width of one histogram bucket
+    uint32_t latency_hist[BTN_LATENCY_BUCKETS]; ///< Raw edge -> DOWN latency (last bucket: all longer)
+    uint32_t latency_max_us;                    ///< Worst raw edge -> DOWN latency
+} btn_stats_t;
+
+/** @brief Largest encoded trace record (varint time delta + varint index). */
+#define BTN_TRACE_RECORD_MAX 12
+
+/** @brief Index of the end-of-trace record written by btn_trace_stop(). */
+#define BTN_TRACE_END 256
+
+/**
+ * @brief Sink for a full trace buffer (e.g. program one flash sector).
+ *
+ * @return true if data was written and the buffer can be reused.
+ */
+typedef bool (*btn_trace_flush_fn_t)(void *arg, const uint8_t *data, size_t len);
+
+/**
+ * @brief Raw input trace recorder (see btn_trace_start()).
+ *
+ * Every raw-state transition seen by the library is appended as two LEB128
+ * varints: time delta in microseconds since the previous record (the first
+ * record holds the absolute time) and the button index. A record toggles the
+ * raw state of its button; buttons start released. btn_trace_stop() ends
+ * the trace with a BTN_TRACE_END record at the stop time.
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t   size;
+    size_t   len;               ///< Bytes used in buf
+
+    btn_trace_flush_fn_t flush_fn;  ///< Optional sink, called when buf is full
+    void                *flush_arg;
+
+    uint64_t last_us;           ///< Time of the last record
+    size_t   records;           ///< Records written
+    size_t   dropped;           ///< Records lost (buffer full, no sink or sink failed)
+} btn_trace_t;
+
+/**
+ * @brief Replay driver for a recorded trace (see btn_replay_step()).
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t         len;
+    size_t         pos;         ///< Read position of the next record
+
+    bool     has_next;          ///< next_us / next_index are valid
+    uint64_t next_us;
+    uint8_t  next_index;
+
+    bool     started;
+    uint64_t now_us;            ///< Time of the last replayed btn_update()
+    uint64_t end_us;            ///< Stop time from the end record (BTN_NO_DEADLINE if none)
+
+    uint32_t levels[8];         ///< Replayed raw state, bit n = button index n
+} btn_replay_t;
+
+/**
+ * @brief What the (non-SPSC) queue does when an event arrives while it is full.
+ */
+typedef enum {
+    BTN_OVERFLOW_DROP_OLDEST = 0,   ///< Overwrite the oldest event (default)
+    BTN_OVERFLOW_DROP_NEWEST,       ///< Discard the new event
+    BTN_OVERFLOW_PRIORITY,          ///< Evict the oldest LONG_HOLD, else the oldest event; a
+                                    ///< LONG_HOLD arriving at a queue without one is discarded
+} btn_overflow_policy_t;
+
 /**
  * @brief Button system context.
  *
@@ -123,20 +541,147 @@ typedef struct {
     btn_instance_t *buttons;
     size_t          btn_count;
 
+    btn_bank_t *banks;          ///< Optional input banks (NULL if not used)
+    size_t      bank_count;
+
+    btn_matrix_t *matrices;     ///< Optional key matrices (see btn_set_matrices())
+    size_t        matrix_count;
+
+    size_t polled_count;        ///< Enabled buttons sampled through read_fn
+
+    uint32_t pressed_mask;      ///< Logical state of buttons[0..31] (bit n = pressed)
+
+    const btn_combo_t *combos;  ///< Optional combo table (see btn_set_combos())
+    btn_combo_state_t *combo_states;
+    size_t             combo_count;
+
+    btn_gesture_engine_t *gestures; ///< Optional gesture matcher (see btn_set_gestures())
+
     btn_event_t *queue;
     size_t       queue_size;
-    size_t       head;
-    size_t       tail;
+    size_t       queue_mask;    ///< queue_size - 1 if it is a power of two, else 0
+    size_t       head;          ///< Written by the producer (btn_update) only
+    size_t       tail;          ///< Written by the consumer (btn_pop_event) in SPSC mode
+
+    /**
+     * @brief Single-producer/single-consumer queue mode (see btn_set_queue_spsc()).
+     */
+    bool queue_spsc;
+
+    btn_overflow_policy_t overflow_policy;  ///< See btn_set_overflow_policy()
+    bool                  coalesce_hold;    ///< Merge back-to-back LONG_HOLD of one button
 
     /**
      * @brief Number of dropped (overwritten) events due to queue overflow.
      *
      * This is incremented whenever the queue is full and the oldest event
-     * is overwritten with a new one. Useful for diagnostics and tuning.
+     * is overwritten with a new one (or, in SPSC / deferred dispatch mode,
+     * a new event is discarded). Useful for diagnostics and tuning.
      */
     size_t dropped_events;
+
+    /**
+     * @brief Edge-triggered mode (see btn_set_edge_mode()).
+     *
+     * When set, idle read_fn buttons are only sampled after btn_notify_edge().
+     */
+    bool edge_mode;
+
+    uint64_t last_update_us;    ///< now_us of the last btn_update()
+
+    uint64_t      next_due;       ///< Earliest button / combo deadline (see btn_next_deadline())
+    volatile bool edge_notified;  ///< btn_notify_edge() since the last btn_update()
+
+    /**
+     * @brief Deferred dispatch ring (see btn_set_deferred_dispatch()).
+     *
+     * NULL in the default mode, where callbacks run inside btn_update().
+     */
+    btn_event_t *pending;
+    size_t       pending_size;
+    size_t       pending_mask;
+    size_t       pending_head;  ///< Written by btn_update() only
+    size_t       pending_tail;  ///< Written by btn_dispatch() only
+
+    /**
+     * @brief Optional ID -> index map (BTN_ID_MAP_SIZE entries, see btn_set_id_map()).
+     */
+    uint8_t *id_map;
+
+    /**
+     * @brief Optional statistics block (see btn_set_stats()), NULL if disabled.
+     */
+    btn_stats_t   *stats;
+    btn_clock_fn_t stats_clock;
+    void          *stats_clock_arg;
+
+    btn_trace_t    *trace;          ///< Optional raw input recorder (see btn_trace_start())
+    const uint32_t *replay_levels;  ///< Raw input source while replaying (see btn_replay_init())
 } btn_context_t;
 
+/** @brief Number of entries in an ID -> index map (one per possible button ID). */
+#define BTN_ID_MAP_SIZE 256
+
+/** @brief ID map entry / lookup result for an unknown button ID. */
+#define BTN_INDEX_NONE 0xFF
+
+/** @brief btn_next_deadline() result when no timer is pending. */
+#define BTN_NO_DEADLINE UINT64_MAX
+
+/* -------------------------------------------------------------------------- */
+/*  Static button tables                                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Timing part of a table entry (milliseconds).
+ *
+ * The table macros use C99 designated initializers; C++ code uses the
+ * constexpr helpers of buttonlib_table.hpp instead.
+ */
+#define BTN_TIMINGS(debounce, click_timeout, long_press, repeat_period) \
+    .debounce_ms      = (debounce),                                     \
+    .click_timeout_ms = (click_timeout),                                \
+    .long_press_ms    = (long_press),                                   \
+    .repeat_period_ms = (repeat_period)
+
+/**
+ * @brief Table entry for a bank button (e.g. GPIO bit of gpio_get_all()).
+ */
+#define BTN_BANK_BUTTON(btn_id, bank_idx, bit, low, timings) \
+    { .id = (btn_id), .active_low = (low), timings,            \
+      .source = BTN_SRC_BANK, .bank = (bank_idx), .bank_bit = (bit) }
+
+/**
+ * @brief Table entry for a button with its own read callback.
+ */
+#define BTN_READ_BUTTON(btn_id, fn, arg, low, timings) \
+    { .id = (btn_id), .active_low = (low),               \
+      .read_fn = (fn), .hw_arg = (arg), timings }
+
+/**
+ * @brief Define the RAM side of a static button table.
+ *
+ * For a `static const btn_config_t name##_configs[]` table (kept in flash),
+ * defines contiguous `name##_states[]` and `name##_buttons[]` arrays and the
+ * `name##_COUNT` constant:
+ *
+ * @code
+ * static const btn_config_t ui_configs[] = {
+ *     BTN_BANK_BUTTON(ID_L, 0, 16, true, BTN_TIMINGS(20, 200, 800, 100)),
+ *     BTN_BANK_BUTTON(ID_C, 0, 17, true, BTN_TIMINGS(20, 200, 800, 0)),
+ * };
+ * BTN_TABLE_DEFINE(ui);
+ *
+ * btn_init(&ctx, ui_buttons, ui_COUNT, queue, 32);
+ * btn_init_banks(&ctx, banks, 1);
+ * btn_setup_table(&ctx, ui_configs, ui_states, ui_COUNT);
+ * @endcode
+ */
+#define BTN_TABLE_DEFINE(name)                                                  \
+    enum { name##_COUNT = sizeof(name##_configs) / sizeof(name##_configs[0]) }; \
+    static btn_state_t    name##_states[name##_COUNT];                          \
+    static btn_instance_t name##_buttons[name##_COUNT]
+
 /* -------------------------------------------------------------------------- */
 /*  Public API                                                                */
 /* -------------------------------------------------------------------------- */
@@ -166,13 +711,335 @@ bool btn_init(btn_context_t *ctx,
  * @param cfg       Button configuration (must outlive the context).
  * @param st        Pointer to button state storage.
  *
- * If cfg is NULL or cfg->read_fn is NULL, the button is considered disabled.
+ * If cfg is NULL, the button is considered disabled. The same applies to
+ * BTN_SRC_READ_FN buttons with a NULL read_fn, and to BTN_SRC_BANK buttons
+ * whose bank/bank_bit do not refer to a bank set up with btn_init_banks()
+ * or whose bit is already taken by another button.
  */
 void btn_setup(btn_context_t *ctx,
                uint8_t index,
                const btn_config_t *cfg,
                btn_state_t *st);
 
+/**
+ * @brief Configure all buttons from a static table in one pass.
+ *
+ * Equivalent to btn_setup(ctx, i, &configs[i], &states[i]) for every i:
+ * whatever a previous setup of the first count slots registered (bank bits,
+ * polled slots, pressed mask) is released first, then the table is applied
+ * in one pass. configs is typically a const array placed in flash, states a
+ * contiguous RAM array.
+ *
+ * @param ctx       Button context (after btn_init() and btn_init_banks()).
+ * @param configs   Button configurations (size = count, must outlive the context).
+ * @param states    Button state storage (size = count).
+ * @param count     Number of entries; must not exceed btn_count or 256.
+ *
+ * @return true if every entry was valid (invalid entries are disabled),
+ *         false also on invalid arguments (nothing is changed then).
+ */
+bool btn_setup_table(btn_context_t *ctx,
+                     const btn_config_t *configs,
+                     btn_state_t *states,
+                     size_t count);
+
+/**
+ * @brief Apply changed timings (or a new configuration) to a running button.
+ *
+ * btn_setup() converts the millisecond timings into microsecond thresholds
+ * once, so btn_update() does not multiply on every pass (compact builds
+ * convert on use and only need this to reschedule). Call this after
+ * modifying the timings of a configuration at runtime.
+ *
+ * The button state (pressed, click series, timers) is preserved.
+ *
+ * @param ctx       Button context.
+ * @param index     Index of an enabled button.
+ * @param cfg       New configuration, or NULL to re-read the current one.
+ *
+ * @return false on invalid arguments or if the new input wiring is invalid
+ *         or its bank bit belongs to another button (the previous
+ *         configuration stays active in that case).
+ */
+bool btn_reconfigure(btn_context_t *ctx, uint8_t index, const btn_config_t *cfg);
+
+/**
+ * @brief Attach an ID -> index lookup table to the context.
+ *
+ * With a map, every ID-based call (btn_is_pressed, btn_get_duration,
+ * btn_suppress_events, btn_notify_edge, btn_find_index) resolves the button
+ * in O(1) instead of scanning the buttons array. The map is filled from the
+ * buttons configured so far and kept up to date by btn_setup().
+ *
+ * @param ctx   Button context.
+ * @param map   Storage for BTN_ID_MAP_SIZE entries (NULL detaches the map).
+ */
+void btn_set_id_map(btn_context_t *ctx, uint8_t *map);
+
+/**
+ * @brief Enable runtime statistics collected by btn_update().
+ *
+ * The raw edge time of a press is the sample (or btn_notify_edge()) time at
+ * which its first raw change was seen; later bounces before the press
+ * commits do not move it. The histogram thus shows how long bouncing,
+ * debouncing and the update period delay BTN_EVT_DOWN. Bucket n counts
+ * latencies in [n * bucket_us, (n + 1) * bucket_us).
+ *
+ * Without stats the hot path pays one NULL check per event and update.
+ *
+ * @param ctx        Button context.
+ * @param stats      Storage for the counters, cleared here (NULL disables stats).
+ * @param bucket_us  Histogram bucket width in microseconds (0 = 1000).
+ * @param clock_fn   Clock used to time btn_update() (NULL: no durations).
+ * @param clock_arg  Argument passed to clock_fn.
+ */
+void btn_set_stats(btn_context_t *ctx,
+                   btn_stats_t *stats,
+                   uint32_t bucket_us,
+                   btn_clock_fn_t clock_fn,
+                   void *clock_arg);
+
+/**
+ * @brief Snapshot the statistics block.
+ *
+ * Copies the counters and fills in update_avg. Call it on the btn_update()
+ * side; a snapshot taken concurrently from another core may mix two updates.
+ *
+ * @param ctx   Button context.
+ * @param out   Output snapshot.
+ * @return false if ctx has no statistics block.
+ */
+bool btn_get_stats(const btn_context_t *ctx, btn_stats_t *out);
+
+/**
+ * @brief Start recording raw-state transitions into a trace.
+ *
+ * Buttons whose raw state is pressed at this point get a record at
+ * last_update_us, so the trace is self-contained. Transitions are logged in
+ * logical polarity from every input path (read_fn, banks, matrices, feeds),
+ * a few bytes each. When buf cannot hold another record it is handed to
+ * flush_fn (if set) and reused; otherwise the record is dropped.
+ *
+ * In edge mode the raw edge time from btn_notify_edge() is recorded; an
+ * edge that bounces back before the next update is not a transition and is
+ * not recorded.
+ *
+ * @param ctx       Button context.
+ * @param trace     Recorder state.
+ * @param buf       Trace buffer (at least BTN_TRACE_RECORD_MAX bytes).
+ * @param size      Size of buf in bytes.
+ * @param flush_fn  Optional sink for full buffers (NULL: stop when full).
+ * @param flush_arg Argument passed to flush_fn.
+ * @return false on invalid arguments.
+ */
+bool btn_trace_start(btn_context_t *ctx,
+                     btn_trace_t *trace,
+                     uint8_t *buf,
+                     size_t size,
+                     btn_trace_flush_fn_t flush_fn,
+                     void *flush_arg);
+
+/**
+ * @brief Stop recording: append the end record and detach the recorder.
+ *
+ * The buffer content is kept; hand the rest to the sink with btn_trace_flush().
+ */
+void btn_trace_stop(btn_context_t *ctx);
+
+/**
+ * @brief Hand the buffered part of a trace to its flush_fn.
+ *
+ * @return true if the buffer was flushed (or empty).
+ */
+bool btn_trace_flush(btn_trace_t *trace);
+
+/**
+ * @brief Prepare a context to replay a trace.
+ *
+ * ctx must be configured like the recorded one (same indexes and timings)
+ * and is dedicated to the replay afterwards: btn_update() takes the raw
+ * state of every button from the trace instead of read_fn / banks. Events
+ * are delivered to callbacks and the queue as usual.
+ *
+ * @param rp    Replay state.
+ * @param ctx   Freshly set up context.
+ * @param data  Trace bytes.
+ * @param len   Trace length in bytes.
+ * @return false on invalid arguments.
+ */
+bool btn_replay_init(btn_replay_t *rp, btn_context_t *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Run one replayed btn_update().
+ *
+ * With step_us > 0 updates run on a fixed grid starting at the first record
+ * (the same period as the recording device reproduces its event stream
+ * exactly). With step_us = 0 the replay jumps straight to the next record or
+ * btn_next_deadline(), whichever comes first, so timers fire at their exact
+ * deadline and long idle periods cost nothing.
+ *
+ * @param ctx       Context passed to btn_replay_init().
+ * @param rp        Replay state.
+ * @param step_us   Update period, 0 = jump between records and deadlines.
+ * @return false once the trace is exhausted and no timer is pending before
+ *         the recorded stop time.
+ */
+bool btn_replay_step(btn_context_t *ctx, btn_replay_t *rp, uint32_t step_us);
+
+/**
+ * @brief Register a combo table.
+ *
+ * Combos are evaluated inside btn_update() with one mask compare per combo
+ * against the logical state of buttons[0..31], replacing per-tick polling of
+ * btn_is_pressed() / btn_get_duration() in the application. The hold timer
+ * is included in btn_next_deadline().
+ *
+ * BTN_EVT_COMBO is not passed to per-button callbacks; choose combo IDs that
+ * do not clash with button IDs.
+ *
+ * @param ctx       Button context.
+ * @param combos    Combo definitions (must outlive the context).
+ * @param states    State storage, one per combo.
+ * @param count     Number of combos (0 removes the table).
+ * @return false on invalid arguments.
+ */
+bool btn_set_combos(btn_context_t *ctx,
+                    const btn_combo_t *combos,
+                    btn_combo_state_t *states,
+                    size_t count);
+
+/**
+ * @brief Compile a gesture table into an automaton.
+ *
+ * Steps match events in order; events that match no step of any gesture
+ * (e.g. the DOWN / UP of a click) are transparent. A step that breaks the
+ * sequence falls back to the longest partial match it continues, as in
+ * string search. More than gap_ms between two matched steps restarts the
+ * sequence.
+ *
+ * After a match the automaton restarts, so a gesture that is a prefix of
+ * another one shadows it.
+ *
+ * @param eng       Automaton storage.
+ * @param gestures  Gesture definitions (only read during compilation).
+ * @param count     Number of gestures (1..BTN_GESTURE_MAX_STATES - 1).
+ * @param gap_ms    Max time between steps (0 = unlimited).
+ * @return false on invalid arguments, an empty gesture, or when the table
+ *         needs more than BTN_GESTURE_MAX_STATES states or
+ *         BTN_GESTURE_MAX_SYMBOLS distinct steps.
+ */
+bool btn_gesture_compile(btn_gesture_engine_t *eng,
+                         const btn_gesture_t *gestures,
+                         size_t count,
+                         uint16_t gap_ms);
+
+/**
+ * @brief Attach a compiled gesture automaton to a context.
+ *
+ * Every emitted event (including COMBO, excluding GESTURE) advances the
+ * automaton after it has been routed; a completed gesture is delivered as
+ * BTN_EVT_GESTURE right after the event that completed it. Like COMBO it
+ * is not passed to per-button callbacks.
+ *
+ * @param ctx   Button context.
+ * @param eng   Compiled automaton (NULL detaches). Restarted on attach.
+ */
+void btn_set_gestures(btn_context_t *ctx, btn_gesture_engine_t *eng);
+
+/**
+ * @brief Attach input banks to the context.
+ *
+ * Must be called after btn_init() and before btn_setup() of any
+ * BTN_SRC_BANK button.
+ *
+ * @param ctx       Button context.
+ * @param banks     Array of banks (size = count).
+ * @param count     Number of banks.
+ *
+ * @return true on success, false on invalid arguments.
+ */
+bool btn_init_banks(btn_context_t *ctx, btn_bank_t *banks, size_t count);
+
+/**
+ * @brief Set the read callback of a bank.
+ *
+ * The callback is invoked once per btn_update() and its result is shared by
+ * all BTN_SRC_BANK buttons of that bank. active_low is applied to the whole
+ * snapshot with a single XOR mask.
+ *
+ * On RP2040 a typical callback simply returns gpio_get_all().
+ *
+ * @param ctx       Button context.
+ * @param index     Bank index (0 .. bank_count-1).
+ * @param read_fn   Bank read callback.
+ * @param arg       Opaque argument passed to read_fn.
+ */
+void btn_setup_bank(btn_context_t *ctx,
+                    uint8_t index,
+                    btn_bank_read_fn_t read_fn,
+                    void *arg);
+
+/**
+ * @brief Feed a timed raw sample into a bank.
+ *
+ * For banks whose samples come from an external sampler (e.g. a PIO state
+ * machine pushing changed masks) instead of a read callback: leave read_fn
+ * NULL and call this for every sample, in time order. Changed bits run the
+ * state machine right away with t_us as the transition time; pending timers
+ * of the bank keep running in btn_update(). With debounce_ms = 0 (input
+ * already filtered by the sampler) DOWN/UP are stamped with t_us exactly.
+ *
+ * @param ctx       Button context.
+ * @param index     Bank index (0 .. bank_count-1).
+ * @param levels    Raw electrical levels (bit n = input n, before active_low).
+ * @param t_us      Time the sample was taken (not later than the next btn_update()).
+ */
+void btn_feed_bank(btn_context_t *ctx, uint8_t index, uint32_t levels, uint64_t t_us);
+
+/**
+ * @brief Feed a batch of evenly spaced raw samples into a bank.
+ *
+ * For high-rate capture (e.g. timer-paced DMA into a ring buffer): sample i
+ * was taken at t0_us + i * period_ns / 1000. Samples are processed in one
+ * pass; only samples that change the bank or reach a pending debounce /
+ * hold / click deadline run the state machine, so transitions and timers
+ * are resolved with sample accuracy at a relaxed btn_update() cadence.
+ *
+ * @param ctx       Button context.
+ * @param index     Bank index (read_fn must be NULL, as for btn_feed_bank()).
+ * @param samples   Raw electrical levels, oldest first.
+ * @param count     Number of samples.
+ * @param t0_us     Time of samples[0].
+ * @param period_ns Sample period in nanoseconds.
+ *
+ * @return Number of samples that ran the state machine.
+ */
+size_t btn_feed_bank_samples(btn_context_t *ctx,
+                             uint8_t index,
+                             const uint32_t *samples,
+                             size_t count,
+                             uint64_t t0_us,
+                             uint32_t period_ns);
+
+/**
+ * @brief Attach key matrices to the context.
+ *
+ * Must be called after btn_init_banks(). The banks covered by each matrix
+ * are marked as externally supplied and their read_fn is not used.
+ *
+ * Every matrix is scanned at the start of btn_update(): for each row
+ * select_fn(arg, row) then read_fn(arg). select_fn is responsible for any
+ * settle delay the hardware needs before the columns are read.
+ *
+ * @param ctx       Button context.
+ * @param matrices  Array of matrices (size = count), NULL to detach.
+ * @param count     Number of matrices.
+ *
+ * @return true on success, false on invalid arguments or if a matrix does
+ *         not fit into the configured banks.
+ */
+bool btn_set_matrices(btn_context_t *ctx, btn_matrix_t *matrices, size_t count);
+
 /**
  * @brief Main update function.
  *
@@ -180,9 +1047,141 @@ void btn_setup(btn_context_t *ctx,
  * increasing timestamp in microseconds.
  *
  * Typical source for RP2040: time_us_64().
+ *
+ * Only buttons whose input changed or whose cached deadline (debounce,
+ * long press, repeat, click timeout) has passed run the state machine. Idle bank buttons
+ * are not visited at all; idle read_fn buttons cost one read and a compare.
+ * Placing read_fn buttons first in the buttons array lets the scan stop
+ * early once all of them were sampled.
  */
 void btn_update(btn_context_t *ctx, uint64_t now_us);
 
+/**
+ * @brief Enable or disable edge-triggered mode.
+ *
+ * In edge-triggered mode the application reports raw input changes with
+ * btn_notify_edge() (typically from a GPIO IRQ) and calls btn_update() only
+ * when woken by such an edge or when btn_next_deadline() expires. Idle
+ * read_fn buttons are not sampled; their state is assumed unchanged until
+ * an edge is notified. Bank buttons are still read once per bank.
+ *
+ * Every raw edge of every button must be notified in this mode.
+ */
+void btn_set_edge_mode(btn_context_t *ctx, bool enable);
+
+/**
+ * @brief Report a raw edge of a button.
+ *
+ * Safe to call from an interrupt handler on the core that runs btn_update():
+ * it only stores the timestamp and sets a pending flag. The debounce window
+ * of the button is restarted at now_us on the next btn_update().
+ * For a BTN_SRC_BANK button the next scan of its bank visits every bit, so
+ * the edge is consumed even if the snapshot bit did not change.
+ *
+ * May also be used in polling mode to get exact edge timestamps.
+ *
+ * @param ctx       Button context.
+ * @param btn_id    Button ID.
+ * @param now_us    Time of the edge in microseconds.
+ */
+void btn_notify_edge(btn_context_t *ctx, uint8_t btn_id, uint64_t now_us);
+
+/**
+ * @brief Get the earliest time btn_update() has to run.
+ *
+ * Takes into account pending edges and all debounce, long-press, auto-repeat
+ * and click-timeout timers. The main loop may sleep until this time or the
+ * next input IRQ, whichever comes first.
+ *
+ * O(1): the earliest deadline is maintained by btn_update() from the cached
+ * per-button deadlines (btn_state_t::due). btn_feed_bank*(),
+ * btn_reconfigure() and btn_suppress_events*() rebuild it (one pass over the
+ * buttons), so a timer they cancel or postpone is not reported.
+ *
+ * Raw changes that have not been notified are not known to the library: in
+ * polling mode btn_update() still has to be called periodically.
+ *
+ * @param ctx   Button context.
+ * @return Absolute time in microseconds (may be in the past), or
+ *         BTN_NO_DEADLINE if nothing is pending.
+ */
+uint64_t btn_next_deadline(const btn_context_t *ctx);
+
+/**
+ * @brief Switch the event queue to lock-free single-producer/single-consumer mode.
+ *
+ * In SPSC mode btn_update() (producer) and btn_pop_event() (consumer) may
+ * run on different RP2040 cores without a mutex or spinlock:
+ *  - head is written only by the producer, tail only by the consumer,
+ *    with acquire/release ordering;
+ *  - on overflow the NEW event is dropped (and counted in dropped_events)
+ *    instead of overwriting the oldest one.
+ *
+ * Only the queue is cross-core safe; all other API calls must stay on the
+ * producer side. Must be called while the queue is empty.
+ *
+ * @param ctx       Button context.
+ * @param enable    true to enable SPSC mode, false for overwrite-oldest.
+ * @return false if ctx is NULL or, when enabling, the queue size is not a
+ *         power of two.
+ */
+bool btn_set_queue_spsc(btn_context_t *ctx, bool enable);
+
+/**
+ * @brief Choose the queue overflow policy and LONG_HOLD coalescing.
+ *
+ * With coalesce_hold, a LONG_HOLD arriving at a full queue whose newest
+ * entry is a LONG_HOLD of the same button replaces that entry instead of
+ * evicting anything: clicks (the repeat index) and timestamp advance, so a
+ * consumer sees how many repeats elapsed. Queue order is preserved, and
+ * entries are only rewritten on overflow (see btn_peek_events()).
+ *
+ * BTN_OVERFLOW_PRIORITY keeps DOWN / UP / CLICK / LONG_START / COMBO /
+ * GESTURE under an auto-repeat flood; eviction from the middle shifts the
+ * older entries (O(queue size), only when full).
+ *
+ * Applies to the default queue mode; in SPSC mode the producer never
+ * touches queued entries, so it always drops the newest event and never
+ * coalesces.
+ *
+ * @param ctx           Button context.
+ * @param policy        Overflow policy.
+ * @param coalesce_hold Merge back-to-back LONG_HOLD events of one button.
+ * @return false on invalid arguments.
+ */
+bool btn_set_overflow_policy(btn_context_t *ctx,
+                             btn_overflow_policy_t policy,
+                             bool coalesce_hold);
+
+/**
+ * @brief Enable deferred callback dispatch.
+ *
+ * In deferred mode btn_update() only records events into buf, so a slow
+ * callback cannot stall the scan (e.g. when btn_update() runs in a timer
+ * ISR). btn_dispatch() later runs the per-button callbacks in order, with
+ * the usual semantics: an event the callback consumes (returns true) is not
+ * queued, all others are pushed to the event queue.
+ *
+ * All events pass through buf in this mode, so btn_dispatch() is the only
+ * producer of the event queue and the time order is preserved. buf is a
+ * lock-free SPSC ring: btn_update() and btn_dispatch() may run in different
+ * contexts. On overflow the new event is dropped (dropped_events).
+ *
+ * @param ctx   Button context.
+ * @param buf   Ring storage (NULL disables deferred mode).
+ * @param size  Number of entries in buf (holds size - 1 events).
+ * @return false on invalid arguments.
+ */
+bool btn_set_deferred_dispatch(btn_context_t *ctx, btn_event_t *buf, size_t size);
+
+/**
+ * @brief Run callbacks for events recorded in deferred mode.
+ *
+ * @param ctx   Button context.
+ * @return Number of recorded events processed (consumed or queued).
+ */
+size_t btn_dispatch(btn_context_t *ctx);
+
 /**
  * @brief Pop next event from the queue.
  *
@@ -192,10 +1191,127 @@ void btn_update(btn_context_t *ctx, uint64_t now_us);
  */
 bool btn_pop_event(btn_context_t *ctx, btn_event_t *evt);
 
+/**
+ * @brief Full 64-bit time of an event.
+ *
+ * With BUTTONLIB_COMPACT_EVENTS: the latest time not after ref_us whose low
+ * 32 bits match the timestamp, i.e. exact for events less than ~71.6
+ * minutes older than ref_us (pass time_us_64() or the last btn_update()
+ * time). Otherwise returns timestamp unchanged.
+ */
+uint64_t btn_event_time_us(const btn_event_t *evt, uint64_t ref_us);
+
+/**
+ * @brief Pop up to max events from the queue in one call.
+ *
+ * Events are copied in order with at most two memcpy() spans.
+ *
+ * @param ctx   Button context.
+ * @param buf   Output buffer (at least max events).
+ * @param max   Maximum number of events to return.
+ * @return Number of events copied (0 if the queue is empty).
+ */
+size_t btn_pop_events(btn_context_t *ctx, btn_event_t *buf, size_t max);
+
+/**
+ * @brief Zero-copy access to queued events.
+ *
+ * Returns a pointer to the oldest queued events inside the ring buffer and
+ * the number of events available contiguously from there (the remainder,
+ * if the ring wraps, is returned by the next peek after a commit).
+ * The events stay queued until btn_commit_events() is called.
+ *
+ * In the default mode the producer may overwrite peeked entries on
+ * overflow (eviction, LONG_HOLD coalescing), so btn_update() must not run
+ * between peek and commit unless the queue has room.
+ * In SPSC mode peeked entries are never touched by the producer.
+ *
+ * @param ctx       Button context.
+ * @param events    Output: pointer to the first event (NULL if empty).
+ * @return Number of contiguous events at *events.
+ */
+size_t btn_peek_events(btn_context_t *ctx, const btn_event_t **events);
+
+/**
+ * @brief Release events obtained with btn_peek_events().
+ *
+ * @param ctx       Button context.
+ * @param count     Number of events processed (clamped to the queue fill).
+ */
+void btn_commit_events(btn_context_t *ctx, size_t count);
+
+/* -------------------------------------------------------------------------- */
+/*  Shards                                                                    */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief One shard of a sharded button set: a context with its own rate.
+ *
+ * Buttons are partitioned into independent contexts (e.g. fast controls at
+ * 1 kHz, menu keys at 50 Hz), each with its own btn_update() owner and
+ * queue. A shard may be driven by btn_update_shards(), by its own timer ISR
+ * or by the other RP2040 core (with btn_set_queue_spsc() on its queue).
+ */
+typedef struct {
+    btn_context_t *ctx;
+    uint32_t       period_us;   ///< Update period of this shard
+    uint64_t       next_us;     ///< Next scheduled btn_update() (managed by btn_update_shards())
+} btn_shard_t;
+
+/**
+ * @brief Update every shard whose period has elapsed.
+ *
+ * A shard is updated at most once per call; a late call does not cause
+ * catch-up updates. Set next_us to 0 (or call with a zeroed shard) to update
+ * a shard on the first call.
+ *
+ * @param shards    Shard array (all shards owned by the calling core).
+ * @param count     Number of shards.
+ * @param now_us    Current time in microseconds.
+ * @return Earliest next_us of all shards (BTN_NO_DEADLINE if count is 0).
+ */
+uint64_t btn_update_shards(btn_shard_t *shards, size_t count, uint64_t now_us);
+
+/**
+ * @brief Pop the oldest queued event of several contexts (k-way merge).
+ *
+ * Compares the queue heads of all contexts and pops the one with the lowest
+ * timestamp (ties go to the lower context index), so the consumer sees one
+ * time-ordered stream across shards. The order within one queue is kept as
+ * is (CLICK carries the time of the last release of its series).
+ *
+ * A slow shard only reports an event after its next update. Events newer
+ * than until_us are left queued, so passing the time up to which every shard
+ * has been updated gives strict ordering; pass UINT64_MAX to merge whatever
+ * is queued. Only consumer-side queue operations are used, so shards in
+ * SPSC mode may be updated on another core meanwhile; shards in the default
+ * overwrite-oldest mode must not be updated during the call.
+ *
+ * With BUTTONLIB_COMPACT_EVENTS, times are compared as wrap-safe 32-bit
+ * differences (queued events and until_us within ~35 minutes).
+ *
+ * @param shards    Contexts to merge (NULL entries are skipped).
+ * @param count     Number of contexts.
+ * @param until_us  Newest timestamp to release.
+ * @param evt       Output event.
+ * @return true if an event was returned.
+ */
+bool btn_merge_pop(btn_context_t *const *shards, size_t count,
+                   uint64_t until_us, btn_event_t *evt);
+
 /* -------------------------------------------------------------------------- */
 /*  Helper API                                                                */
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Find the index of a button in the buttons array.
+ *
+ * Useful to resolve IDs once and then use the *_idx helpers in hot code.
+ *
+ * @return Index (0 .. btn_count-1), or -1 if the button is not found.
+ */
+int btn_find_index(btn_context_t *ctx, uint8_t btn_id);
+
 /**
  * @brief Check if a button is logically pressed.
  *
@@ -230,8 +1346,12 @@ uint64_t btn_get_duration(btn_context_t *ctx,
  *
  * This is typically used to handle button combos (chords) where normal
  * per-button events must be ignored once the combo is recognized.
+ *
+ * Only available with BUTTONLIB_ENABLE_SUPPRESS.
  */
+#if BUTTONLIB_ENABLE_SUPPRESS
 void btn_suppress_events(btn_context_t *ctx, uint8_t btn_id);
+#endif
 
 /**
  * @brief Get number of dropped (overwritten) events due to queue overflow.
@@ -241,6 +1361,18 @@ void btn_suppress_events(btn_context_t *ctx, uint8_t btn_id);
  */
 size_t btn_get_dropped_events(const btn_context_t *ctx);
 
+/**
+ * @brief Index-based variants of the helpers above.
+ *
+ * Same semantics, but take the index in the buttons array instead of the
+ * button ID, so no lookup is performed at all.
+ */
+bool     btn_is_pressed_idx(btn_context_t *ctx, size_t index);
+uint64_t btn_get_duration_idx(btn_context_t *ctx, size_t index, uint64_t now_us);
+#if BUTTONLIB_ENABLE_SUPPRESS
+void     btn_suppress_events_idx(btn_context_t *ctx, size_t index);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
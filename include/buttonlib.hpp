@@ -0,0 +1,223 @@
+/**
+ * @file buttonlib.hpp
+ * @brief Header-only C++17 front end for ButtonLib.
+ *
+ * btn::ButtonBank<N, ReadPolicy, QueuePolicy> owns the context, instance,
+ * state, bank and queue storage inline (no allocation) and samples all N
+ * buttons through one inlined ReadPolicy::read() per update: no function
+ * pointer dispatch on the input path. The sample is fed into bank 0 of the
+ * owned context, so bit n of the read mask is the button with bank_bit n.
+ *
+ * @code
+ * static uint32_t read_pins() { return gpio_get_all() >> 16; }
+ *
+ * static constexpr btn::Timings kUi{20, 200, 800, 100};
+ * static constexpr std::array<btn_config_t, 3> kButtons{{
+ *     btn::bank_button(ID_L, 0, 0, true, kUi),
+ *     btn::bank_button(ID_C, 0, 1, true, kUi),
+ *     btn::bank_button(ID_R, 0, 2, true, kUi),
+ * }};
+ *
+ * static btn::ButtonBank<3, btn::FnRead<read_pins>, btn::SpscQueue<32>> ui;
+ *
+ * ui.begin(kButtons);
+ * while (true) {
+ *     ui.update(time_us_64());
+ *     btn_event_t evt;
+ *     while (ui.pop(evt)) { ... }
+ * }
+ * @endcode
+ *
+ * Unused state machine features are removed at library build time (see
+ * the BUTTONLIB_ENABLE_* options).
+ */
+
+#ifndef BUTTONLIB_HPP
+#define BUTTONLIB_HPP
+
+#include "buttonlib.h"
+#include "buttonlib_expander.h"
+#include "buttonlib_table.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace btn {
+
+/* -------------------------------------------------------------------------- */
+/*  Queue policies                                                            */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Default queue: overwrites the oldest event when full, or applies
+ *        another overflow policy / LONG_HOLD coalescing (see btn_set_overflow_policy()).
+ */
+template <std::size_t Size,
+          btn_overflow_policy_t Overflow = BTN_OVERFLOW_DROP_OLDEST,
+          bool CoalesceHold = false>
+struct RingQueue {
+    static_assert(Size > 0, "queue size must be non-zero");
+    static constexpr std::size_t           size     = Size;
+    static constexpr bool                  spsc     = false;
+    static constexpr btn_overflow_policy_t overflow = Overflow;
+    static constexpr bool                  coalesce = CoalesceHold;
+};
+
+/** @brief Cross-core SPSC queue (see btn_set_queue_spsc()); drops the newest event. */
+template <std::size_t Size>
+struct SpscQueue {
+    static_assert(Size > 1 && (Size & (Size - 1)) == 0, "SPSC queue size must be a power of two");
+    static constexpr std::size_t size = Size;
+    static constexpr bool        spsc = true;
+};
+
+/* -------------------------------------------------------------------------- */
+/*  Read policies                                                             */
+/* -------------------------------------------------------------------------- */
+
+/** @brief Compile-time read function (inlined), e.g. a gpio_get_all() wrapper. */
+template <uint32_t (*Read)()>
+struct FnRead {
+    uint32_t read() const { return Read(); }
+};
+
+/** @brief Cached port of an asynchronous expander (see buttonlib_expander.h). */
+struct ExpanderRead {
+    btn_expander_t *expander = nullptr;
+
+    uint32_t read() const { return btn_expander_read(expander); }
+};
+
+/**
+ * @brief Key matrix packed into one mask: bit (row * Cols + col).
+ *
+ * Select(row) drives one row, ReadCols() returns the raw column levels
+ * (bit c = column c). Rows that share two or more pressed columns with
+ * another row are ambiguous (ghosting): new presses in them are held back,
+ * releases pass.
+ */
+template <std::size_t Rows, std::size_t Cols,
+          void (*Select)(uint8_t row), uint32_t (*ReadCols)(), bool ActiveLow = true>
+struct MatrixRead {
+    static_assert(Rows > 0 && Cols > 0 && Rows * Cols <= 32, "matrix must fit into 32 bits");
+
+    static constexpr uint32_t col_mask = (Cols == 32) ? 0xFFFFFFFFu : ((1UL << Cols) - 1u);
+
+    uint32_t read() {
+        uint32_t cols[Rows];
+
+        for (std::size_t r = 0; r < Rows; r++) {
+            Select(static_cast<uint8_t>(r));
+            uint32_t raw = ReadCols();
+            cols[r] = (ActiveLow ? ~raw : raw) & col_mask;
+        }
+
+        uint32_t ghosted = 0;
+        for (std::size_t a = 0; a < Rows; a++) {
+            if (!(cols[a] & (cols[a] - 1))) continue;
+            for (std::size_t b = a + 1; b < Rows; b++) {
+                uint32_t shared = cols[a] & cols[b];
+                if (shared & (shared - 1)) ghosted |= (1UL << a) | (1UL << b);
+            }
+        }
+
+        uint32_t mask = 0;
+        for (std::size_t r = 0; r < Rows; r++) {
+            uint32_t row = cols[r];
+            if (ghosted & (1UL << r)) {
+                row &= (last_ >> (r * Cols)) & col_mask; // Releases only
+            }
+            mask |= row << (r * Cols);
+        }
+
+        last_ = mask;
+        return mask; // Logical polarity: configure keys with active_low = false
+    }
+
+private:
+    uint32_t last_ = 0;
+};
+
+/* -------------------------------------------------------------------------- */
+/*  ButtonBank                                                                */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief N buttons sampled through one read policy, with inline storage.
+ *
+ * @tparam N            Number of buttons (1..32).
+ * @tparam ReadPolicy   Type with `uint32_t read()`; bit n = bank_bit n.
+ * @tparam QueuePolicy  RingQueue<Size> or SpscQueue<Size>.
+ */
+template <std::size_t N, class ReadPolicy, class QueuePolicy = RingQueue<16>>
+class ButtonBank {
+    static_assert(N >= 1 && N <= 32, "ButtonBank holds 1..32 buttons");
+
+public:
+    ButtonBank() = default;
+    ButtonBank(const ButtonBank &) = delete;
+    ButtonBank &operator=(const ButtonBank &) = delete;
+
+    /**
+     * @brief Wire the buttons. Entries must be bank buttons of bank 0
+     *        (btn::bank_button(id, 0, bit, ...)) and outlive the object.
+     *
+     * @return false if an entry is not a valid bank-0 button.
+     */
+    bool begin(const std::array<btn_config_t, N> &configs) {
+        for (const btn_config_t &c : configs) {
+            if (c.source != BTN_SRC_BANK || c.bank != 0) return false;
+        }
+
+        btn_init(&ctx_, buttons_, N, queue_, QueuePolicy::size);
+        btn_init_banks(&ctx_, &bank_, 1);
+        if constexpr (QueuePolicy::spsc) {
+            btn_set_queue_spsc(&ctx_, true);
+        } else {
+            btn_set_overflow_policy(&ctx_, QueuePolicy::overflow, QueuePolicy::coalesce);
+        }
+
+        return btn_setup_table(&ctx_, configs.data(), states_, N);
+    }
+
+    /** @brief One inlined read, then the regular update pass. */
+    void update(uint64_t now_us) {
+        btn_feed_bank(&ctx_, 0, reader_.read(), now_us);
+        btn_update(&ctx_, now_us);
+    }
+
+    bool pop(btn_event_t &evt) { return btn_pop_event(&ctx_, &evt); }
+
+    std::size_t pop(btn_event_t *buf, std::size_t max) {
+        return btn_pop_events(&ctx_, buf, max);
+    }
+
+    bool     pressed(std::size_t index) { return btn_is_pressed_idx(&ctx_, index); }
+    uint64_t duration(std::size_t index, uint64_t now_us) {
+        return btn_get_duration_idx(&ctx_, index, now_us);
+    }
+#if BUTTONLIB_ENABLE_SUPPRESS
+    void     suppress(std::size_t index) { btn_suppress_events_idx(&ctx_, index); }
+#endif
+
+    uint64_t    next_deadline() const { return btn_next_deadline(&ctx_); }
+    std::size_t dropped_events() const { return btn_get_dropped_events(&ctx_); }
+
+    ReadPolicy    &reader()  { return reader_; }
+    btn_context_t *context() { return &ctx_; }
+
+    static constexpr std::size_t size = N;
+
+private:
+    ReadPolicy     reader_{};
+    btn_context_t  ctx_{};
+    btn_bank_t     bank_{};
+    btn_instance_t buttons_[N]{};
+    btn_state_t    states_[N]{};
+    btn_event_t    queue_[QueuePolicy::size]{};
+};
+
+} // namespace btn
+
+#endif // BUTTONLIB_HPP
@@ -0,0 +1,77 @@
+/**
+ * @file buttonlib_dma.h
+ * @brief RP2040 timer-paced DMA capture of GPIO snapshots for ButtonLib banks.
+ *
+ * A DMA pacing timer copies the GPIO input register into a circular buffer
+ * at a fixed rate (e.g. 10–50 kHz) without any per-sample interrupt. Each
+ * btn_dma_service() call feeds every snapshot captured since the previous
+ * call into a bank in one batch pass, with timestamps reconstructed from
+ * the sample counter, so debounce is sample-accurate while btn_update()
+ * runs at a relaxed cadence.
+ *
+ * Requires the Pico SDK (target buttonlib_dma).
+ */
+
+#ifndef BUTTONLIB_DMA_H
+#define BUTTONLIB_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "buttonlib.h"
+#include "pico/types.h"
+
+/**
+ * @brief Capture driver state (allocated by the user).
+ */
+typedef struct {
+    uint32_t *buf;              ///< Ring buffer, aligned to its size in bytes
+    uint32_t  size;             ///< Number of samples in buf (power of two)
+    uint8_t   ring_bits;        ///< log2 of the buffer size in bytes
+
+    uint      dma_chan;
+    uint      dma_timer;
+    uint32_t  period_ns;        ///< Exact sample period of the pacing timer
+
+    uint32_t  consumed;         ///< Samples fed so far (free-running)
+    uint8_t   bank;             ///< Target bank (read_fn must be NULL)
+
+    size_t    overruns;         ///< Samples overwritten before they were fed
+} btn_dma_t;
+
+/**
+ * @brief Claim a DMA channel and pacing timer and start the capture.
+ *
+ * @param drv        Driver state.
+ * @param buf        Ring buffer of 2^ring_bits bytes, aligned to its size
+ *                   (e.g. __attribute__((aligned(1024))) uint32_t buf[256]).
+ * @param ring_bits  log2 of the buffer size in bytes (3..15).
+ * @param sample_hz  Sampling rate (about 2 kHz .. clk_sys).
+ * @param bank       Bank fed by btn_dma_service().
+ *
+ * @return true on success, false on invalid arguments or if no DMA channel
+ *         or timer is free.
+ */
+bool btn_dma_init(btn_dma_t *drv,
+                  uint32_t *buf,
+                  uint8_t ring_bits,
+                  uint32_t sample_hz,
+                  uint8_t bank);
+
+/**
+ * @brief Feed all snapshots captured since the previous call into the bank.
+ *
+ * Call right before btn_update(), at least once per buffer length of samples
+ * (e.g. 256 samples at 20 kHz = 12.8 ms); older samples are counted in
+ * overruns and skipped.
+ *
+ * @return Number of snapshots fed.
+ */
+size_t btn_dma_service(btn_dma_t *drv, btn_context_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTONLIB_DMA_H
@@ -0,0 +1,135 @@
+/**
+ * @file buttonlib_expander.h
+ * @brief Asynchronous GPIO expander banks (MCP23017 / MCP23S17 / PCF8575).
+ *
+ * Each expander is one ButtonLib bank. Its bank read callback never touches
+ * the bus: it returns the port mask cached by the last completed transfer
+ * and requests a new one. Transfers are started through a user-provided
+ * non-blocking transport (IRQ- or DMA-completed) and arbitrated per bus, so
+ * a tick costs at most one bus read per expander regardless of the number
+ * of buttons on it, and btn_update() never blocks on I2C/SPI.
+ *
+ * Samples lag by one transfer (typically one tick).
+ *
+ * Hardware-agnostic: see buttonlib_i2c_dma.h for an RP2040 I2C transport.
+ */
+
+#ifndef BUTTONLIB_EXPANDER_H
+#define BUTTONLIB_EXPANDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "buttonlib.h"
+
+/** @brief Maximum number of expanders on one bus. */
+#define BTN_EXPANDER_MAX 32
+
+/** @brief Transfer completion callback (may run in IRQ context). */
+typedef void (*btn_xfer_done_fn_t)(void *done_arg, bool ok);
+
+/**
+ * @brief Start a non-blocking "write tx, then read rx" transfer.
+ *
+ * Must return immediately; done(done_arg, ok) is called exactly once when
+ * the transfer has finished (it may be called before returning). Returns
+ * false if the transfer could not be started (done is not called then).
+ */
+typedef bool (*btn_xfer_start_fn_t)(void *bus_arg,
+                                    uint8_t addr,
+                                    const uint8_t *tx, size_t tx_len,
+                                    uint8_t *rx, size_t rx_len,
+                                    btn_xfer_done_fn_t done,
+                                    void *done_arg);
+
+/**
+ * @brief Supported expander chips (16-bit ports).
+ */
+typedef enum {
+    BTN_EXP_MCP23017 = 0,   ///< I2C, GPIOA/GPIOB read in one transfer (IOCON.BANK = 0)
+    BTN_EXP_MCP23S17,       ///< SPI variant, hardware address in the opcode
+    BTN_EXP_PCF8575,        ///< I2C quasi-bidirectional port, no register address
+} btn_expander_type_t;
+
+struct btn_expander_bus;
+
+/**
+ * @brief One expander (managed by the library after btn_expander_setup()).
+ */
+typedef struct {
+    struct btn_expander_bus *bus;
+    uint8_t  index;             ///< Position on the bus
+    uint8_t  addr;              ///< 7-bit bus address (0..7 for MCP23S17)
+    uint8_t  tx[2];             ///< Command / register bytes
+    uint8_t  tx_len;
+    uint8_t  rx[2];             ///< Transfer target (written by the transport)
+
+    uint32_t port;              ///< Cached port mask (bit n = pin n, GPIOA/P0x first)
+    size_t   reads;             ///< Completed transfers
+    size_t   errors;            ///< Failed or unstartable transfers
+} btn_expander_t;
+
+/**
+ * @brief Bus shared by several expanders; one transfer at a time.
+ */
+typedef struct btn_expander_bus {
+    btn_xfer_start_fn_t start_fn;
+    void               *arg;        ///< Opaque argument passed to start_fn
+
+    btn_expander_t *expanders;
+    size_t          count;
+
+    uint32_t pending;               ///< Expanders with a requested read (bit n = index n)
+    bool     busy;                  ///< A transfer is running
+    uint8_t  next;                  ///< Round-robin cursor
+} btn_expander_bus_t;
+
+/**
+ * @brief Initialize a bus and its expanders.
+ *
+ * @param bus       Bus state.
+ * @param expanders Array of expanders (size = count, up to BTN_EXPANDER_MAX).
+ * @param count     Number of expanders.
+ * @param start_fn  Non-blocking transport.
+ * @param arg       Opaque argument passed to start_fn.
+ *
+ * @return true on success, false on invalid arguments.
+ */
+bool btn_expander_bus_init(btn_expander_bus_t *bus,
+                           btn_expander_t *expanders,
+                           size_t count,
+                           btn_xfer_start_fn_t start_fn,
+                           void *arg);
+
+/**
+ * @brief Configure one expander of the bus.
+ *
+ * The chip must already be configured for input (pull-ups, IODIR, ...);
+ * only the port is read here.
+ *
+ * @param bus       Bus state.
+ * @param index     Expander index (0 .. count-1).
+ * @param type      Chip type.
+ * @param addr      7-bit I2C address, or hardware address for MCP23S17.
+ * @param idle      Port mask reported until the first read completes
+ *                  (e.g. 0xFFFF for pull-ups with active-low buttons).
+ */
+void btn_expander_setup(btn_expander_bus_t *bus,
+                        uint8_t index,
+                        btn_expander_type_t type,
+                        uint8_t addr,
+                        uint32_t idle);
+
+/**
+ * @brief Bank read callback: cached port mask, requests the next read.
+ *
+ * Use with btn_setup_bank(ctx, bank, btn_expander_read, &expanders[i]).
+ */
+uint32_t btn_expander_read(void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTONLIB_EXPANDER_H
@@ -0,0 +1,69 @@
+/**
+ * @file buttonlib_i2c_dma.h
+ * @brief RP2040 DMA-driven I2C transport for buttonlib_expander.
+ *
+ * Transfers are queued into the I2C TX FIFO and drained by two DMA
+ * channels; completion is reported from the DMA (or I2C abort) interrupt,
+ * so starting a read costs a few register writes and never waits on the bus.
+ *
+ * Requires the Pico SDK (target buttonlib_i2c_dma).
+ */
+
+#ifndef BUTTONLIB_I2C_DMA_H
+#define BUTTONLIB_I2C_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "buttonlib_expander.h"
+#include "hardware/i2c.h"
+
+/** @brief Maximum tx_len + rx_len of one transfer. */
+#define BTN_I2C_DMA_MAX_CMDS 4
+
+/**
+ * @brief Transport state (allocated by the user, one per I2C block).
+ */
+typedef struct {
+    i2c_inst_t *i2c;
+    uint        tx_chan;
+    uint        rx_chan;
+
+    uint32_t cmds[BTN_I2C_DMA_MAX_CMDS]; ///< IC_DATA_CMD words of the running transfer
+
+    btn_xfer_done_fn_t done;        ///< NULL while idle
+    void              *done_arg;
+} btn_i2c_dma_t;
+
+/**
+ * @brief Claim two DMA channels and enable completion interrupts.
+ *
+ * The I2C block must already be initialized (i2c_init(), pin functions).
+ * The application routes DMA_IRQ_0 (rx channel) and the I2C interrupt to
+ * btn_i2c_dma_irq().
+ *
+ * @return true on success, false if no DMA channels are free.
+ */
+bool btn_i2c_dma_init(btn_i2c_dma_t *drv, i2c_inst_t *i2c);
+
+/**
+ * @brief btn_xfer_start_fn_t implementation (bus_arg = btn_i2c_dma_t*).
+ */
+bool btn_i2c_dma_start(void *bus_arg,
+                       uint8_t addr,
+                       const uint8_t *tx, size_t tx_len,
+                       uint8_t *rx, size_t rx_len,
+                       btn_xfer_done_fn_t done,
+                       void *done_arg);
+
+/**
+ * @brief Interrupt hook: completes the running transfer on DMA done or NACK.
+ */
+void btn_i2c_dma_irq(btn_i2c_dma_t *drv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTONLIB_I2C_DMA_H
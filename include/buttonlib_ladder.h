@@ -0,0 +1,117 @@
+/**
+ * @file buttonlib_ladder.h
+ * @brief Resistor-ladder buttons on one ADC input, decoded into a bank mask.
+ *
+ * Several buttons share one analog pin through a resistor ladder; every
+ * pressed state (including multi-key chords the ladder can tell apart)
+ * produces a distinct nominal ADC reading. The ladder is one ButtonLib
+ * bank: its read callback performs a single conversion per tick and maps
+ * the reading to a button mask through a sorted level table, so debounce,
+ * clicks and long presses run through the standard bank pipeline.
+ *
+ * A reading farther than the tolerance from every nominal level (the
+ * voltage is still settling between two states) keeps the previous mask.
+ *
+ * For free-running ADC + DMA capture, decode blocks of readings with
+ * btn_ladder_feed_samples() into a bank without read_fn.
+ *
+ * Hardware-agnostic: the conversion is a user callback (e.g. adc_read()).
+ */
+
+#ifndef BUTTONLIB_LADDER_H
+#define BUTTONLIB_LADDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "buttonlib.h"
+
+/** @brief ADC conversion callback: one raw reading. */
+typedef uint16_t (*btn_adc_read_fn_t)(void *arg);
+
+/**
+ * @brief One ladder state (table entry).
+ */
+typedef struct {
+    uint16_t raw;       ///< Nominal ADC reading of the state
+    uint32_t mask;      ///< Pressed buttons (bit n = bank bit n); 0 = none pressed
+} btn_ladder_level_t;
+
+/**
+ * @brief Ladder decoder state (allocated by the user).
+ */
+typedef struct {
+    btn_adc_read_fn_t read_fn;
+    void             *arg;          ///< Opaque argument passed to read_fn
+
+    const btn_ladder_level_t *levels;   ///< Sorted by raw, ascending
+    size_t                    count;
+    uint16_t                  tolerance; ///< Max distance from a nominal reading (0 = nearest level)
+
+    uint32_t mask;              ///< Last decoded mask
+    uint16_t last_raw;          ///< Last reading
+    size_t   samples;           ///< Decoded readings
+    size_t   rejected;          ///< Readings outside every tolerance window
+} btn_ladder_t;
+
+/**
+ * @brief Initialize a ladder decoder.
+ *
+ * Readings between two levels are assigned to the nearer one (threshold at
+ * the midpoint), unless they are farther than tolerance from both.
+ *
+ * @param ld        Decoder state.
+ * @param levels    Level table sorted by strictly increasing raw (must
+ *                  outlive the decoder); include the idle level (mask 0).
+ * @param count     Number of levels.
+ * @param tolerance Max distance from a nominal reading (0 = unlimited).
+ * @param read_fn   ADC conversion for btn_ladder_read() (may be NULL when
+ *                  only btn_ladder_feed_samples() is used).
+ * @param arg       Opaque argument passed to read_fn.
+ * @return false on invalid arguments or an unsorted table.
+ */
+bool btn_ladder_init(btn_ladder_t *ld,
+                     const btn_ladder_level_t *levels,
+                     size_t count,
+                     uint16_t tolerance,
+                     btn_adc_read_fn_t read_fn,
+                     void *arg);
+
+/**
+ * @brief Decode one reading into a button mask.
+ *
+ * Binary search over the level table; out-of-tolerance readings return
+ * (and keep) the previous mask.
+ */
+uint32_t btn_ladder_decode(btn_ladder_t *ld, uint16_t raw);
+
+/**
+ * @brief Bank read callback: one conversion, decoded.
+ *
+ * Use with btn_setup_bank(ctx, bank, btn_ladder_read, &ladder) and
+ * active_low = false for the ladder buttons.
+ */
+uint32_t btn_ladder_read(void *arg);
+
+/**
+ * @brief Decode a block of evenly spaced readings and feed it into a bank.
+ *
+ * Same timing as btn_feed_bank_samples(): reading i was taken at
+ * t0_us + i * period_ns / 1000.
+ *
+ * @return Number of samples that ran the state machine.
+ */
+size_t btn_ladder_feed_samples(btn_ladder_t *ld,
+                               btn_context_t *ctx,
+                               uint8_t bank,
+                               const uint16_t *raw,
+                               size_t count,
+                               uint64_t t0_us,
+                               uint32_t period_ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTONLIB_LADDER_H
@@ -0,0 +1,99 @@
+/**
+ * @file buttonlib_pio.h
+ * @brief RP2040 PIO sampler for ButtonLib banks.
+ *
+ * A PIO state machine samples up to 32 consecutive GPIOs at a fixed rate,
+ * rejects short glitches (first-stage debounce) and pushes only changed
+ * masks into its RX FIFO. The driver timestamps the masks and feeds them
+ * into a bank with btn_feed_bank(), so the CPU only handles real
+ * transitions and sampling jitter does not depend on the main loop.
+ *
+ * Requires the Pico SDK (target buttonlib_pio).
+ */
+
+#ifndef BUTTONLIB_PIO_H
+#define BUTTONLIB_PIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "buttonlib.h"
+#include "hardware/pio.h"
+
+/** @brief Number of timestamped samples buffered between capture and service. */
+#define BTN_PIO_RING_SIZE 16
+
+/**
+ * @brief Timestamped sample taken from the RX FIFO.
+ */
+typedef struct {
+    uint32_t levels;    ///< Raw pin levels (bit n = GPIO pin_base + n)
+    uint64_t t_us;      ///< Time the sample was drained
+} btn_pio_sample_t;
+
+/**
+ * @brief PIO sampler driver state (allocated by the user).
+ */
+typedef struct {
+    PIO     pio;
+    uint    sm;
+    uint    offset;
+    uint    pin_base;
+    uint32_t pin_mask;          ///< Valid bits of a sample
+    uint8_t bank;               ///< Target bank (read_fn must be NULL)
+
+    btn_pio_sample_t ring[BTN_PIO_RING_SIZE];
+    size_t  head;               ///< Written by btn_pio_capture() only
+    size_t  tail;               ///< Written by btn_pio_service() only
+
+    size_t  overruns;           ///< Samples left in the FIFO because the ring was full
+} btn_pio_t;
+
+/**
+ * @brief Load the sampler program and start a state machine.
+ *
+ * Pins must already be configured as inputs (with pulls as needed).
+ *
+ * @param drv       Driver state.
+ * @param pio       PIO block (pio0 / pio1).
+ * @param pin_base  First sampled GPIO (bank bit 0).
+ * @param pin_count Number of sampled GPIOs (1..32); other GPIOs are not read.
+ * @param sample_hz Sampling rate of the state machine. The clock divider
+ *                  clk_sys / (6 * sample_hz) must lie in 1..65536 (about
+ *                  320 Hz .. 20.8 MHz at 125 MHz).
+ * @param bank      Bank fed by btn_pio_service().
+ *
+ * @return true on success, false on invalid arguments (including an out of
+ *         range sample_hz) or if no state machine or program space is free.
+ */
+bool btn_pio_init(btn_pio_t *drv,
+                  PIO pio,
+                  uint pin_base,
+                  uint pin_count,
+                  float sample_hz,
+                  uint8_t bank);
+
+/**
+ * @brief Drain the RX FIFO into the driver ring with timestamps.
+ *
+ * Either call it from a PIO RX-not-empty interrupt (precise timestamps,
+ * single producer) or right before btn_pio_service() in the main loop.
+ */
+void btn_pio_capture(btn_pio_t *drv);
+
+/**
+ * @brief Feed captured samples into the bank.
+ *
+ * Call before btn_update(). Each sample becomes a timed transition for the
+ * changed bits of the bank.
+ *
+ * @return Number of samples fed.
+ */
+size_t btn_pio_service(btn_pio_t *drv, btn_context_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTONLIB_PIO_H
@@ -0,0 +1,102 @@
+/**
+ * @file buttonlib_sleep.h
+ * @brief RP2040 low-power wait for ButtonLib: sleep until the next deadline or a pin edge.
+ *
+ * Puts the core to sleep between btn_update() calls instead of a fixed
+ * sleep_ms() poll. Wake sources are GPIO edges of the registered pins and
+ * the timer for the earliest pending deadline (debounce, click timeout,
+ * long press, repeat, combo), taken from btn_next_deadline().
+ *
+ * Three levels, chosen per call from the library state:
+ *  - WFE: clocks keep running (default, USB stdio stays alive);
+ *  - deep sleep (deep_sleep): SLEEPDEEP with only the timer and GPIO
+ *    clocks enabled while the core sleeps;
+ *  - DORMANT (dormant): when no deadline is pending at all, the crystal is
+ *    stopped and only a pin level change wakes the chip. The clocks are
+ *    restored on wake (USB does not survive). The microsecond timer does not advance while
+ *    dormant, so time_us_64() simply continues after wake; no library timer
+ *    can be pending across DORMANT, so debouncing the wake edge is exact.
+ *
+ * The registered pins are handled by a shared GPIO IRQ handler that calls
+ * btn_notify_edge() (edge mode is enabled on the context). Only one
+ * btn_sleep_t can be active.
+ *
+ * Requires the Pico SDK (target buttonlib_sleep).
+ */
+
+#ifndef BUTTONLIB_SLEEP_H
+#define BUTTONLIB_SLEEP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "buttonlib.h"
+#include "pico/types.h"
+
+/** @brief Number of GPIOs that can be wake sources (bit n of pin_mask = GPIO n). */
+#define BTN_SLEEP_MAX_PINS 32
+
+/**
+ * @brief Wake pin: GPIO and the button it belongs to.
+ */
+typedef struct {
+    uint8_t gpio;
+    uint8_t btn_id;
+} btn_sleep_pin_t;
+
+/**
+ * @brief Low-power wait state (allocated by the user).
+ */
+typedef struct {
+    btn_context_t *ctx;
+    uint32_t pin_mask;                      ///< Registered GPIOs
+    uint8_t  pin_ids[BTN_SLEEP_MAX_PINS];   ///< Button ID per GPIO
+
+    bool deep_sleep;            ///< Gate all clocks but timer / GPIO while sleeping
+    bool dormant;               ///< Enter DORMANT when no deadline is pending
+
+    volatile bool woken;        ///< Set by the GPIO IRQ, cleared by btn_sleep_wait()
+
+    size_t sleeps;              ///< WFE / deep sleep waits
+    size_t dormant_entries;     ///< DORMANT entries
+} btn_sleep_t;
+
+/**
+ * @brief Register the wake pins and install the GPIO IRQ handler.
+ *
+ * Pins must already be configured as inputs (with pulls as needed). Every
+ * read_fn button of the context must have its pin registered, because edge
+ * mode is enabled and such buttons are only sampled after an edge. Bank
+ * buttons may be registered too: their IRQ edges give exact timestamps.
+ * After DORMANT only the read_fn buttons are notified, since the edge IRQ
+ * logic was stopped; banks are read by the next btn_update() anyway.
+ *
+ * deep_sleep and dormant start disabled; set them after this call.
+ *
+ * @param sl     Wait state.
+ * @param ctx    Button context.
+ * @param pins   Wake pins (copied).
+ * @param count  Number of pins.
+ * @return false on invalid arguments (GPIO out of range, count 0).
+ */
+bool btn_sleep_init(btn_sleep_t *sl,
+                    btn_context_t *ctx,
+                    const btn_sleep_pin_t *pins,
+                    size_t count);
+
+/**
+ * @brief Sleep until the next library deadline or a pin edge.
+ *
+ * Call it after btn_update() and draining the queue. Returns immediately if
+ * a deadline has already passed or an edge arrived since the last update.
+ *
+ * @return time_us_64() at wake, to pass to btn_update().
+ */
+uint64_t btn_sleep_wait(btn_sleep_t *sl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTONLIB_SLEEP_H
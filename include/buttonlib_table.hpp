@@ -0,0 +1,178 @@
+/**
+ * @file buttonlib_table.hpp
+ * @brief C++17 compile-time button tables for ButtonLib.
+ *
+ * The full button set is declared as a constexpr std::array of btn_config_t
+ * (placed in flash), validated with static_assert, and paired with
+ * contiguous state / instance storage in RAM:
+ *
+ * @code
+ * static constexpr btn::Timings kUi{20, 200, 800, 100};
+ * static constexpr std::array<btn_config_t, 3> kButtons{{
+ *     btn::bank_button(ID_L, 0, 16, true, kUi),
+ *     btn::bank_button(ID_C, 0, 17, true, kUi),
+ *     btn::bank_button(ID_R, 0, 18, true, kUi),
+ * }};
+ * static btn::Table<kButtons> table;
+ *
+ * btn_init(&ctx, table.buttons(), table.size, queue, 32);
+ * btn_init_banks(&ctx, banks, 1);
+ * table.setup(&ctx);
+ * @endcode
+ *
+ * Bank masks are available as constants (Table::bank_mask(), invert_mask()).
+ */
+
+#ifndef BUTTONLIB_TABLE_HPP
+#define BUTTONLIB_TABLE_HPP
+
+#include "buttonlib.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace btn {
+
+/** @brief Timings of a table entry (milliseconds). */
+struct Timings {
+    uint16_t debounce_ms      = 20;
+    uint16_t click_timeout_ms = 250;
+    uint16_t long_press_ms    = 800;
+    uint16_t repeat_period_ms = 0;
+};
+
+namespace detail {
+
+constexpr btn_config_t with_timings(btn_config_t c, const Timings &t) {
+    c.debounce_ms      = t.debounce_ms;
+    c.click_timeout_ms = t.click_timeout_ms;
+    c.long_press_ms    = t.long_press_ms;
+    c.repeat_period_ms = t.repeat_period_ms;
+    return c;
+}
+
+} // namespace detail
+
+/** @brief Table entry for a bank button (e.g. GPIO bit of gpio_get_all()). */
+constexpr btn_config_t bank_button(uint8_t id, uint8_t bank, uint8_t bit,
+                                   bool active_low, const Timings &t = {}) {
+    btn_config_t c{};
+    c.id         = id;
+    c.active_low = active_low;
+    c.source     = BTN_SRC_BANK;
+    c.bank       = bank;
+    c.bank_bit   = bit;
+    return detail::with_timings(c, t);
+}
+
+/** @brief Table entry for a button with its own read callback. */
+constexpr btn_config_t read_button(uint8_t id, btn_read_fn_t read_fn, void *hw_arg,
+                                   bool active_low, const Timings &t = {}) {
+    btn_config_t c{};
+    c.id         = id;
+    c.active_low = active_low;
+    c.read_fn    = read_fn;
+    c.hw_arg     = hw_arg;
+    return detail::with_timings(c, t);
+}
+
+/** @brief True if no two entries share a button ID. */
+template <std::size_t N>
+constexpr bool unique_ids(const std::array<btn_config_t, N> &c) {
+    for (std::size_t i = 0; i < N; i++) {
+        for (std::size_t j = i + 1; j < N; j++) {
+            if (c[i].id == c[j].id) return false;
+        }
+    }
+    return true;
+}
+
+/** @brief True if every bank entry uses a bit < 32 not shared with another entry. */
+template <std::size_t N>
+constexpr bool valid_bank_bits(const std::array<btn_config_t, N> &c) {
+    for (std::size_t i = 0; i < N; i++) {
+        if (c[i].source != BTN_SRC_BANK) continue;
+        if (c[i].bank_bit >= 32) return false;
+
+        for (std::size_t j = i + 1; j < N; j++) {
+            if (c[j].source == BTN_SRC_BANK &&
+                c[j].bank == c[i].bank && c[j].bank_bit == c[i].bank_bit) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** @brief True if every read_fn entry has a callback. */
+template <std::size_t N>
+constexpr bool valid_read_fns(const std::array<btn_config_t, N> &c) {
+    for (std::size_t i = 0; i < N; i++) {
+        if (c[i].source != BTN_SRC_BANK && !c[i].read_fn) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Static table: constexpr configuration plus contiguous RAM storage.
+ *
+ * @tparam Configs  A constexpr std::array<btn_config_t, N> with static storage.
+ */
+template <const auto &Configs>
+class Table {
+    using ConfigArray = std::remove_cv_t<std::remove_reference_t<decltype(Configs)>>;
+
+public:
+    static constexpr std::size_t size = std::tuple_size<ConfigArray>::value;
+
+    static_assert(size > 0, "button table is empty");
+    static_assert(unique_ids(Configs), "duplicate button IDs in table");
+    static_assert(valid_bank_bits(Configs), "bank bit out of range or used twice");
+    static_assert(valid_read_fns(Configs), "read_fn entry without a callback");
+
+    /** @brief Bits of a bank used by the table (compile-time constant). */
+    static constexpr uint32_t bank_mask(uint8_t bank) {
+        uint32_t mask = 0;
+        for (const btn_config_t &c : Configs) {
+            if (c.source == BTN_SRC_BANK && c.bank == bank) mask |= 1UL << c.bank_bit;
+        }
+        return mask;
+    }
+
+    /** @brief active_low bits of a bank (compile-time constant). */
+    static constexpr uint32_t invert_mask(uint8_t bank) {
+        uint32_t mask = 0;
+        for (const btn_config_t &c : Configs) {
+            if (c.source == BTN_SRC_BANK && c.bank == bank && c.active_low) {
+                mask |= 1UL << c.bank_bit;
+            }
+        }
+        return mask;
+    }
+
+    /** @brief Index of a button ID in the table (compile-time constant). */
+    static constexpr std::size_t index_of(uint8_t id) {
+        for (std::size_t i = 0; i < size; i++) {
+            if (Configs[i].id == id) return i;
+        }
+        return BTN_INDEX_NONE;
+    }
+
+    btn_instance_t *buttons() { return buttons_; }
+    btn_state_t    *states()  { return states_; }
+
+    /** @brief Wire the whole table into ctx (see btn_setup_table()). */
+    bool setup(btn_context_t *ctx) {
+        return btn_setup_table(ctx, Configs.data(), states_, size);
+    }
+
+private:
+    btn_state_t    states_[size]  = {};
+    btn_instance_t buttons_[size] = {};
+};
+
+} // namespace btn
+
+#endif // BUTTONLIB_TABLE_HPP
@@ -1,15 +1,104 @@
 #include "buttonlib.h"
 #include <string.h>
 
-#define MS_TO_US(x) ((uint64_t)(x) * 1000ULL)
+#define MS_TO_US(x) ((btn_time_t)(x) * 1000u)
 #define LONG_PRESS_ACTIVE 0xFF
 
+// Index publication for the SPSC queue (one side writes, the other reads).
+#if defined(__GNUC__)
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define LOAD_ACQUIRE(p)     (*(volatile size_t *)(p))
+#define STORE_RELEASE(p, v) (*(volatile size_t *)(p) = (v))
+#endif
+
+#if BUTTONLIB_COMPACT_EVENTS
+_Static_assert(sizeof(btn_event_t) == 8, "compact btn_event_t must stay 8 bytes");
+#endif
+
+#if BUTTONLIB_COMPACT_STATE
+_Static_assert(sizeof(btn_state_t) <= 24, "compact btn_state_t must stay within 24 bytes");
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*  Internal helpers                                                          */
 /* -------------------------------------------------------------------------- */
 
+static inline uint8_t lowest_bit(uint32_t v) {
+#if defined(__GNUC__)
+    return (uint8_t)__builtin_ctz(v);
+#else
+    uint8_t n = 0;
+    while (!(v & 1u)) { v >>= 1; n++; }
+    return n;
+#endif
+}
+
+/*
+ * Time helpers. State times are btn_time_t (32-bit in compact mode), so all
+ * intervals are computed as wrap-safe differences in btn_time_t.
+ */
+static inline btn_time_t elapsed(btn_time_t now, btn_time_t since) {
+    return (btn_time_t)(now - since);
+}
+
+static inline bool time_before(btn_time_t a, btn_time_t b) {
+#if BUTTONLIB_COMPACT_STATE
+    return (int32_t)(a - b) < 0;
+#else
+    return a < b;
+#endif
+}
+
+/** Rebuild a full 64-bit timestamp for a state time not later than ref_us. */
+static inline uint64_t expand_time(uint64_t ref_us, btn_time_t t) {
+    return ref_us - elapsed((btn_time_t)ref_us, t);
+}
+
+/*
+ * Event time order. Compact events hold 32-bit times, compared as
+ * wrap-safe differences (events within ~35 minutes of each other).
+ */
+static inline bool event_before(const btn_event_t *a, const btn_event_t *b) {
+#if BUTTONLIB_COMPACT_EVENTS
+    return (int32_t)(a->timestamp - b->timestamp) < 0;
+#else
+    return a->timestamp < b->timestamp;
+#endif
+}
+
+static inline bool event_not_after(const btn_event_t *evt, uint64_t until_us) {
+#if BUTTONLIB_COMPACT_EVENTS
+    return until_us == UINT64_MAX || (int32_t)(evt->timestamp - (uint32_t)until_us) <= 0;
+#else
+    return evt->timestamp <= until_us;
+#endif
+}
+
+/** Rebuild a full 64-bit timestamp for a deadline within +-2^31 us of ref_us. */
+static inline uint64_t expand_due(uint64_t ref_us, btn_time_t t) {
+#if BUTTONLIB_COMPACT_STATE
+    return ref_us + (uint64_t)(int64_t)(int32_t)(t - (btn_time_t)ref_us);
+#else
+    (void)ref_us;
+    return t;
+#endif
+}
+
 static int find_index(btn_context_t *ctx, uint8_t id) {
     if (!ctx) return -1;
+
+    if (ctx->id_map) {
+        // O(1): the entry is verified, so stale slots simply miss.
+        uint8_t i = ctx->id_map[id];
+        if (i < ctx->btn_count && ctx->buttons[i].config &&
+            ctx->buttons[i].config->id == id) {
+            return (int)i;
+        }
+        return -1;
+    }
+
     for (size_t i = 0; i < ctx->btn_count; i++) {
         if (ctx->buttons[i].config &&
             ctx->buttons[i].config->id == id) {
@@ -19,20 +108,260 @@ static int find_index(btn_context_t *ctx, uint8_t id) {
     return -1;
 }
 
+static inline size_t queue_next(const btn_context_t *ctx, size_t i) {
+    return ctx->queue_mask ? ((i + 1) & ctx->queue_mask)
+                           : ((i + 1) % ctx->queue_size);
+}
+
+/**
+ * Consumer view of the queue: current tail and number of queued events.
+ * In SPSC mode head is loaded with acquire so the entries are visible.
+ */
+static inline size_t queue_prev(const btn_context_t *ctx, size_t i) {
+    if (ctx->queue_mask) return (i - 1) & ctx->queue_mask;
+    return i ? i - 1 : ctx->queue_size - 1;
+}
+
+static size_t queue_pending(btn_context_t *ctx, size_t *tail) {
+    size_t head = ctx->queue_spsc ? LOAD_ACQUIRE(&ctx->head) : ctx->head;
+
+    *tail = ctx->tail;
+    return (head >= *tail) ? (head - *tail) : (ctx->queue_size - *tail + head);
+}
+
+static void queue_release(btn_context_t *ctx, size_t tail, size_t count) {
+    tail += count;
+    if (tail >= ctx->queue_size) {
+        tail -= ctx->queue_size;
+    }
+
+    if (ctx->queue_spsc) {
+        STORE_RELEASE(&ctx->tail, tail);
+    } else {
+        ctx->tail = tail;
+    }
+}
+
+static inline void count_up(uint32_t *counter) {
+    if (*counter != UINT32_MAX) (*counter)++;
+}
+
+/** Track the queue high-water mark after a push (head = new head). */
+static void note_fill(btn_context_t *ctx, size_t head) {
+    size_t tail = ctx->queue_spsc ? LOAD_ACQUIRE(&ctx->tail) : ctx->tail;
+    size_t fill = (head >= tail) ? (head - tail) : (ctx->queue_size - tail + head);
+
+    if (fill > ctx->stats->queue_high_water) {
+        ctx->stats->queue_high_water = fill;
+    }
+}
+
+/** Record the raw edge -> DOWN latency of a press. */
+static void note_latency(btn_stats_t *stats, btn_time_t latency) {
+    uint32_t us = (latency > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency;
+    uint32_t n  = us / stats->latency_bucket_us;
+
+    count_up(&stats->latency_hist[n < BTN_LATENCY_BUCKETS ? n : BTN_LATENCY_BUCKETS - 1]);
+    if (us > stats->latency_max_us) {
+        stats->latency_max_us = us;
+    }
+}
+
+/** Append v as LEB128 (7 bits per byte, high bit = more). */
+static size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static bool get_varint(const uint8_t *p, size_t len, size_t *pos, uint64_t *v) {
+    uint64_t r = 0;
+    for (unsigned shift = 0; *pos < len && shift < 64; shift += 7) {
+        uint8_t b = p[(*pos)++];
+        r |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = r;
+            return true;
+        }
+    }
+    return false;   // Truncated or malformed
+}
+
+/** Append one raw transition of button index at time t_us to the trace. */
+static void trace_edge(btn_trace_t *tr, size_t index, uint64_t t_us) {
+    if (tr->size - tr->len < BTN_TRACE_RECORD_MAX && !btn_trace_flush(tr)) {
+        tr->dropped++;
+        return;
+    }
+
+    // IRQ edge times may precede an already recorded sample: keep deltas >= 0.
+    if (t_us < tr->last_us) t_us = tr->last_us;
+
+    tr->len += put_varint(&tr->buf[tr->len], t_us - tr->last_us);
+    tr->len += put_varint(&tr->buf[tr->len], index);
+    tr->last_us = t_us;
+    tr->records++;
+}
+
+/** Auto-repeat is the only event type a UI can lose without losing a transition. */
+static inline uint8_t event_priority(btn_event_type_t type) {
+    return type == BTN_EVT_LONG_HOLD ? 0 : 1;
+}
+
+/**
+ * Free one slot of a full queue for an event of the given type.
+ * Returns false if the new event is the one to drop.
+ */
+static bool make_room(btn_context_t *ctx, btn_event_type_t type) {
+    if (ctx->overflow_policy == BTN_OVERFLOW_DROP_NEWEST) return false;
+
+    size_t victim = ctx->tail;
+
+    if (ctx->overflow_policy == BTN_OVERFLOW_PRIORITY) {
+        // Oldest entry of the lowest priority not above the new event.
+        uint8_t best = (uint8_t)(event_priority(type) + 1);
+        victim = SIZE_MAX;
+
+        for (size_t i = ctx->tail; i != ctx->head && best > 0; i = queue_next(ctx, i)) {
+            uint8_t p = event_priority(ctx->queue[i].type);
+            if (p < best) {
+                best   = p;
+                victim = i;
+            }
+        }
+        if (victim == SIZE_MAX) return false;
+
+        // Close the gap: entries older than the victim move up by one.
+        for (size_t i = victim; i != ctx->tail; ) {
+            size_t prev = queue_prev(ctx, i);
+            ctx->queue[i] = ctx->queue[prev];
+            i = prev;
+        }
+    }
+
+    ctx->tail = queue_next(ctx, ctx->tail);
+    return true;
+}
+
 static void push_event(btn_context_t *ctx, btn_event_t evt) {
     if (!ctx || !ctx->queue || ctx->queue_size == 0) return;
 
-    size_t next = (ctx->head + 1) % ctx->queue_size;
+    if (ctx->queue_spsc) {
+        // Drop-newest: the producer never touches tail.
+        size_t head = ctx->head;
+        size_t next = queue_next(ctx, head);
 
-    // Overwrite-oldest strategy:
-    // If the queue is full, drop the oldest event and increment diagnostics.
+        if (next == LOAD_ACQUIRE(&ctx->tail)) {
+            ctx->dropped_events++;
+            return;
+        }
+
+        ctx->queue[head] = evt;
+        STORE_RELEASE(&ctx->head, next);
+        if (ctx->stats) note_fill(ctx, next);
+        return;
+    }
+
+    size_t next = queue_next(ctx, ctx->head);
+
+    // Full: evict per overflow policy (default: overwrite the oldest event).
     if (next == ctx->tail) {
-        ctx->tail = (ctx->tail + 1) % ctx->queue_size;
+        // A repeat right behind the previous repeat of its button only
+        // advances it instead of costing an event.
+        if (ctx->coalesce_hold && evt.type == BTN_EVT_LONG_HOLD) {
+            btn_event_t *last = &ctx->queue[queue_prev(ctx, ctx->head)];
+            if (last->type == BTN_EVT_LONG_HOLD && last->btn_id == evt.btn_id) {
+                *last = evt;
+                return;
+            }
+        }
+
         ctx->dropped_events++;
+        if (!make_room(ctx, evt.type)) return;
     }
 
     ctx->queue[ctx->head] = evt;
     ctx->head = next;
+    if (ctx->stats) note_fill(ctx, next);
+}
+
+/**
+ * Deferred dispatch ring (producer: btn_update, consumer: btn_dispatch).
+ * Same SPSC discipline as the event queue: drop-newest on overflow.
+ */
+static inline size_t pending_next(const btn_context_t *ctx, size_t i) {
+    return ctx->pending_mask ? ((i + 1) & ctx->pending_mask)
+                             : ((i + 1) % ctx->pending_size);
+}
+
+static void pending_push(btn_context_t *ctx, btn_event_t evt) {
+    size_t head = ctx->pending_head;
+    size_t next = pending_next(ctx, head);
+
+    if (next == LOAD_ACQUIRE(&ctx->pending_tail)) {
+        ctx->dropped_events++;
+        return;
+    }
+
+    ctx->pending[head] = evt;
+    STORE_RELEASE(&ctx->pending_head, next);
+}
+
+static bool pending_pop(btn_context_t *ctx, btn_event_t *evt) {
+    size_t tail = ctx->pending_tail;
+    if (tail == LOAD_ACQUIRE(&ctx->pending_head)) return false;
+
+    *evt = ctx->pending[tail];
+    STORE_RELEASE(&ctx->pending_tail, pending_next(ctx, tail));
+    return true;
+}
+
+static void update_gesture(btn_context_t *ctx, const btn_event_t *evt);
+
+/** Route an event: deferred ring, per-button callback, then queue. */
+static void route(btn_context_t *ctx, const btn_config_t *cfg, btn_event_t evt) {
+    if (ctx->pending) {
+        // Deferred mode: callbacks run later in btn_dispatch().
+        pending_push(ctx, evt);
+        return;
+    }
+
+    if (cfg && cfg->callback && cfg->callback(&evt, cfg->cb_user_data)) {
+        // Callback consumed the event.
+        return;
+    }
+
+    push_event(ctx, evt);
+}
+
+/**
+ * Emit an event: count it, route it, then feed the gesture matcher.
+ * cfg is NULL for events not tied to a single button (e.g. COMBO).
+ */
+static void deliver(btn_context_t *ctx, const btn_config_t *cfg, btn_event_t evt) {
+    if (ctx->stats && evt.type < BTN_EVT_TYPE_COUNT) {
+        count_up(&ctx->stats->events[evt.type]);
+    }
+
+    route(ctx, cfg, evt);
+
+    if (ctx->gestures && evt.type != BTN_EVT_GESTURE) {
+        update_gesture(ctx, &evt);
+    }
+}
+
+/** True while events of the button are suppressed (always false without SUPPRESS). */
+static inline bool is_suppressed(const btn_state_t *st) {
+#if BUTTONLIB_ENABLE_SUPPRESS
+    return st->suppressed;
+#else
+    (void)st;
+    return false;
+#endif
 }
 
 static void emit(btn_context_t *ctx,
@@ -42,7 +371,7 @@ static void emit(btn_context_t *ctx,
                  uint8_t clicks,
                  uint64_t timestamp) {
 
-    if (st->suppressed) {
+    if (is_suppressed(st)) {
         // Suppressed buttons do not emit any events.
         return;
     }
@@ -54,242 +383,1619 @@ static void emit(btn_context_t *ctx,
         .timestamp = timestamp
     };
 
-    if (cfg->callback && cfg->callback(&evt, cfg->cb_user_data)) {
-        // Callback consumed the event.
-        return;
-    }
+    deliver(ctx, cfg, evt);
+}
 
-    push_event(ctx, evt);
+/** True if a bank config names an existing bank and bit. */
+static inline bool bank_slot_valid(const btn_context_t *ctx, const btn_config_t *cfg) {
+    return ctx->banks && cfg->bank < ctx->bank_count && cfg->bank_bit < 32;
 }
 
-/* -------------------------------------------------------------------------- */
-/*  Public API                                                                */
-/* -------------------------------------------------------------------------- */
+/** True if the bank bit of cfg is valid and not taken by another button. */
+static inline bool bank_slot_free(const btn_context_t *ctx, uint8_t index, const btn_config_t *cfg) {
+    if (!bank_slot_valid(ctx, cfg)) return false;
 
-bool btn_init(btn_context_t *ctx,
-              btn_instance_t *buttons,
-              size_t count,
-              btn_event_t *queue,
-              size_t q_size) {
-    if (!ctx || !buttons) return false;
+    const btn_bank_t *bank = &ctx->banks[cfg->bank];
+    return !(bank->used_mask & (1UL << cfg->bank_bit)) ||
+           bank->btn_index[cfg->bank_bit] == index;
+}
 
-    memset(ctx, 0, sizeof(btn_context_t));
-    ctx->buttons   = buttons;
-    ctx->btn_count = count;
-    ctx->queue     = queue;
-    ctx->queue_size = q_size;
+static void bank_unregister(btn_context_t *ctx, const btn_config_t *cfg) {
+    if (!cfg || cfg->source != BTN_SRC_BANK) return;
+    if (!bank_slot_valid(ctx, cfg)) return;
 
-    return true;
+    btn_bank_t *bank = &ctx->banks[cfg->bank];
+    uint32_t    bit  = 1UL << cfg->bank_bit;
+
+    bank->used_mask   &= ~bit;
+    bank->busy_mask   &= ~bit;
+    bank->invert_mask &= ~bit;
+    bank->snapshot    &= ~bit;
 }
 
-void btn_setup(btn_context_t *ctx,
-               uint8_t index,
-               const btn_config_t *cfg,
-               btn_state_t *st) {
-    if (!ctx || index >= ctx->btn_count || !st) return;
+static bool bank_register(btn_context_t *ctx, uint8_t index, const btn_config_t *cfg) {
+    if (!bank_slot_free(ctx, index, cfg)) return false;
 
-    memset(st, 0, sizeof(btn_state_t));
+    btn_bank_t *bank = &ctx->banks[cfg->bank];
+    uint32_t    bit  = 1UL << cfg->bank_bit;
 
-    // Validate configuration: read_fn must be non-null.
-    if (!cfg || !cfg->read_fn) {
-        ctx->buttons[index].config = NULL;
-        ctx->buttons[index].state  = NULL;
-        return;
+    bank->used_mask |= bit;
+    bank->busy_mask |= bit;
+    bank->btn_index[cfg->bank_bit] = index;
+    if (cfg->active_low) {
+        bank->invert_mask |= bit;
+    } else {
+        bank->invert_mask &= ~bit;
     }
+    bank->snapshot &= ~bit;
 
-    ctx->buttons[index].config = cfg;
-    ctx->buttons[index].state  = st;
+    return true;
 }
 
-void btn_update(btn_context_t *ctx, uint64_t now_us) {
-    if (!ctx) return;
+/** True for enabled buttons sampled through their own read_fn. */
+static inline bool is_polled(const btn_config_t *cfg) {
+    return cfg && cfg->source != BTN_SRC_BANK && cfg->read_fn;
+}
 
-    for (size_t i = 0; i < ctx->btn_count; i++) {
-        const btn_config_t *cfg = ctx->buttons[i].config;
-        btn_state_t        *st  = ctx->buttons[i].state;
-        if (!cfg || !st) continue;
-        if (!cfg->read_fn) continue; // Safety
+/**
+ * Make sure a bank button is visited on the next scan even if its bit
+ * does not change (used when state is modified outside step_button()).
+ */
+static void mark_busy(btn_context_t *ctx, const btn_config_t *cfg) {
+    if (cfg->source != BTN_SRC_BANK) return;
+    ctx->banks[cfg->bank].busy_mask |= 1UL << cfg->bank_bit;
+}
 
-        /* 1. Read hardware (raw state) */
-        bool raw = cfg->read_fn(cfg->hw_arg);
-        if (cfg->active_low) {
-            raw = !raw;
+/**
+ * Thresholds in tick units. The default state caches them at setup; the
+ * compact state converts the config value on use (one 32-bit multiply)
+ * instead of carrying four copies per button.
+ */
+#if BUTTONLIB_COMPACT_STATE
+#define THRESHOLD(cfg, st, name) ((void)(st), MS_TO_US((cfg)->name##_ms))
+#else
+#define THRESHOLD(cfg, st, name) ((void)(cfg), (st)->name##_us)
+#endif
+
+/** Convert the millisecond timings of cfg into cached tick-unit thresholds. */
+static void load_thresholds(btn_state_t *st, const btn_config_t *cfg) {
+#if BUTTONLIB_COMPACT_STATE
+    (void)st;
+    (void)cfg;
+#else
+    st->debounce_us       = MS_TO_US(cfg->debounce_ms);
+#if BUTTONLIB_ENABLE_MULTICLICK
+    st->click_timeout_us  = MS_TO_US(cfg->click_timeout_ms);
+#endif
+#if BUTTONLIB_ENABLE_LONGPRESS
+    st->long_press_us     = MS_TO_US(cfg->long_press_ms);
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
+    st->repeat_period_us  = MS_TO_US(cfg->repeat_period_ms);
+#endif
+#endif
+}
+
+/**
+ * Consume an edge reported by btn_notify_edge().
+ *
+ * The IRQ side writes edge_time before setting edge_pending. If another edge
+ * arrives while we read the 64-bit timestamp, the flag is set again and the
+ * read is retried, so a torn value is never returned.
+ */
+static bool take_edge(btn_state_t *st, btn_time_t *edge_t) {
+    if (!st->edge_pending) return false;
+
+    btn_time_t t;
+    do {
+        st->edge_pending = false;
+        t = st->edge_time;
+    } while (st->edge_pending);
+
+    *edge_t = t;
+    return true;
+}
+
+/**
+ * Next long-press / repeat / click-timeout deadline of the logical state.
+ * All thresholds are strict ("> threshold"), hence the +1.
+ */
+static bool timer_due(const btn_config_t *cfg, const btn_state_t *st, btn_time_t *due) {
+    btn_time_t since;
+    btn_time_t period;
+
+    (void)cfg;      // Unused with LONGPRESS and MULTICLICK both disabled
+
+    if (st->logic_state) {
+#if BUTTONLIB_ENABLE_LONGPRESS
+        if (st->click_count != LONG_PRESS_ACTIVE) {
+            since  = st->state_start_time;
+            period = THRESHOLD(cfg, st, long_press);
         }
+#if BUTTONLIB_ENABLE_REPEAT
+        else if (THRESHOLD(cfg, st, repeat_period) > 0) {
+            since  = st->last_repeat_time;
+            period = THRESHOLD(cfg, st, repeat_period);
+        }
+#endif
+        else {
+            return false;
+        }
+#else
+        return false;
+#endif
+    } else {
+#if BUTTONLIB_ENABLE_LONGPRESS
+        if (st->click_count == LONG_PRESS_ACTIVE) {
+            *due = st->last_debounce_time; // Stale long-press marker: clean up now
+            return true;
+        }
+#endif
+#if BUTTONLIB_ENABLE_MULTICLICK
+        if (st->click_count == 0) {
+            return false;
+        }
+        since  = st->last_release_time;
+        period = THRESHOLD(cfg, st, click_timeout);
+#else
+        return false;
+#endif
+    }
+
+    *due = since + period + 1;
+    return true;
+}
 
-        /* 2. Debounce on raw changes */
-        if (raw != st->raw_state) {
-            st->last_debounce_time = now_us;
-            st->raw_state = raw;
+/**
+ * Next time step_button() has timer work for this button: the earlier of a
+ * pending debounce commit and the logical-state timer (a bouncing input
+ * must not hold back a click timeout). Returns false if only an input
+ * change can give it work.
+ */
+static bool state_due(const btn_config_t *cfg, const btn_state_t *st, btn_time_t *due) {
+    bool has_timer = timer_due(cfg, st, due);
+
+    if (st->raw_state != st->logic_state) {
+        btn_time_t commit = st->last_debounce_time + THRESHOLD(cfg, st, debounce) + 1;
+        if (!has_timer || time_before(commit, *due)) {
+            *due = commit;
         }
+        return true;
+    }
 
-        bool stable = st->logic_state;
+    return has_timer;
+}
 
-        if ((now_us - st->last_debounce_time) > MS_TO_US(cfg->debounce_ms)) {
-            if (st->logic_state != raw) {
-                stable = raw;
-                st->logic_state = raw;
+/** Cache the next deadline of a button after its state changed. */
+static void schedule(const btn_config_t *cfg, btn_state_t *st) {
+    btn_time_t due = 0;
+    st->has_due = state_due(cfg, st, &due);
+    st->due     = due;
+}
 
-                if (stable) {
-                    /* -> PRESSED (logical) */
-                    st->state_start_time  = now_us;
-                    st->last_repeat_time  = now_us;
-                    st->hold_repeat_count = 0;
-                    st->suppressed        = false; // New press cancels suppression
+/** True if a press held from state_start_time until now counts as a click. */
+static inline bool short_press(const btn_config_t *cfg, const btn_state_t *st, btn_time_t now) {
+#if BUTTONLIB_ENABLE_LONGPRESS
+    return elapsed(now, st->state_start_time) < THRESHOLD(cfg, st, long_press);
+#else
+    (void)cfg;
+    (void)st;
+    (void)now;
+    return true;
+#endif
+}
 
-                    emit(ctx, cfg, st, BTN_EVT_DOWN, 0, now_us);
-                } else {
-                    /* -> RELEASED (logical) */
-                    emit(ctx, cfg, st, BTN_EVT_UP, 0, now_us);
+/**
+ * Run the per-button state machine for one sample.
+ *
+ * raw is the raw state in logical polarity (true = pressed). timed is set
+ * when now_us is the exact sample time of raw (see btn_feed_bank()).
+ */
+static void step_button(btn_context_t *ctx,
+                        size_t index,
+                        const btn_config_t *cfg,
+                        btn_state_t *st,
+                        bool raw,
+                        bool timed,
+                        uint64_t now_us) {
+    btn_time_t now = (btn_time_t)now_us;
 
-                    if (!st->suppressed) {
-                        uint64_t duration = now_us - st->state_start_time;
+    /* 1. Debounce on raw changes */
+    btn_time_t edge_t;
+    bool       changed = (raw != st->raw_state);
 
-                        // Short presses contribute to a click series
-                        if (duration < MS_TO_US(cfg->long_press_ms)) {
-                            st->click_count++;
-                            st->last_release_time = now_us;
-                        } else {
-                            // Long press clears click series
-                            st->click_count = 0;
-                        }
-                    }
-                }
-            }
-        }
+    // A released input that rested for a full window starts a new press;
+    // bounces inside the window keep the first edge.
+    bool press_start = changed && raw && !st->logic_state &&
+                       (!st->first_edge ||
+                        elapsed(now, st->last_debounce_time) > THRESHOLD(cfg, st, debounce));
+
+    if (take_edge(st, &edge_t)) {
+        // Exact edge time from IRQ; clamp in case it raced past now_us.
+        st->last_debounce_time = time_before(edge_t, now) ? edge_t : now;
+        st->raw_state = raw;
+    } else if (changed) {
+        st->last_debounce_time = now;
+        st->raw_state = raw;
+    }
+
+    // state_start_time is unused while released: it holds the first edge.
+    if (press_start) {
+        st->state_start_time = st->last_debounce_time;
+        st->first_edge       = true;
+    }
+
+    if (changed && ctx->trace) {
+        trace_edge(ctx->trace, index, expand_time(now_us, st->last_debounce_time));
+    }
 
-        /* 3. Long press / auto-repeat / click timeout */
-        if (stable) {
-            /* == HELD == */
-            uint64_t hold_time = now_us - st->state_start_time;
+    bool stable = st->logic_state;
 
-            if (hold_time > MS_TO_US(cfg->long_press_ms)) {
-                if (st->click_count != LONG_PRESS_ACTIVE) {
-                    st->click_count       = LONG_PRESS_ACTIVE; // Mark as handled
-                    st->hold_repeat_count = 0;                 // Reset per-hold counter
+    // Timed samples of an already filtered input (e.g. PIO sampler, debounce
+    // 0) commit at the sample time instead of on the next update.
+    if ((timed && THRESHOLD(cfg, st, debounce) == 0) ||
+        elapsed(now, st->last_debounce_time) > THRESHOLD(cfg, st, debounce)) {
+        if (st->logic_state != raw) {
+            stable = raw;
+            st->logic_state = raw;
 
-                    emit(ctx, cfg, st, BTN_EVT_LONG_START, 0, now_us);
-                    st->last_repeat_time = now_us;
+            if (stable) {
+                /* -> PRESSED (logical) */
+                if (ctx->stats) {
+                    btn_time_t edge = st->first_edge ? st->state_start_time
+                                                     : st->last_debounce_time;
+                    note_latency(ctx->stats, elapsed(now, edge));
                 }
+                st->first_edge        = false;
+                st->state_start_time  = now;
+#if BUTTONLIB_ENABLE_REPEAT
+                st->last_repeat_time  = now;
+                st->hold_repeat_count = 0;
+#endif
+#if BUTTONLIB_ENABLE_SUPPRESS
+                st->suppressed        = false; // New press cancels suppression
+#endif
 
-                // Auto-repeat while held
-                if (cfg->repeat_period_ms > 0) {
-                    if ((now_us - st->last_repeat_time) >
-                        MS_TO_US(cfg->repeat_period_ms)) {
+                if (index < 32) ctx->pressed_mask |= 1UL << index;
 
-                        // Increment with saturation at 0xFF to avoid wraparound
-                        if (st->hold_repeat_count < 0xFF) {
-                            st->hold_repeat_count++;
-                        }
+                emit(ctx, cfg, st, BTN_EVT_DOWN, 0, now_us);
+            } else {
+                /* -> RELEASED (logical) */
+                if (index < 32) ctx->pressed_mask &= ~(1UL << index);
 
-                        emit(ctx, cfg, st,
-                             BTN_EVT_LONG_HOLD,
-                             st->hold_repeat_count,
-                             now_us);
+                emit(ctx, cfg, st, BTN_EVT_UP, 0, now_us);
 
-                        st->last_repeat_time = now_us;
+                if (!is_suppressed(st)) {
+                    if (short_press(cfg, st, now)) {
+#if BUTTONLIB_ENABLE_MULTICLICK
+                        // Short presses contribute to a click series
+                        st->click_count++;
+                        st->last_release_time = now;
+#else
+                        // No series: every short press is a single click
+                        emit(ctx, cfg, st, BTN_EVT_CLICK, 1, now_us);
+#endif
+                    }
+#if BUTTONLIB_ENABLE_LONGPRESS
+                    else {
+                        // Long press clears click series
+                        st->click_count = 0;
                     }
+#endif
                 }
             }
-        } else {
-            /* == IDLE (not logically pressed) == */
+        }
+    }
+
+    /* 2. Long press / auto-repeat / click timeout */
+    if (stable) {
+        /* == HELD == */
+#if BUTTONLIB_ENABLE_LONGPRESS
+        btn_time_t hold_time = elapsed(now, st->state_start_time);
 
-            // Check click timeout for accumulated short presses
-            if (st->click_count > 0 &&
-                st->click_count != LONG_PRESS_ACTIVE) {
+        if (hold_time > THRESHOLD(cfg, st, long_press)) {
+            if (st->click_count != LONG_PRESS_ACTIVE) {
+                st->click_count       = LONG_PRESS_ACTIVE; // Mark as handled
+#if BUTTONLIB_ENABLE_REPEAT
+                st->hold_repeat_count = 0;                 // Reset per-hold counter
+#endif
 
-                if ((now_us - st->last_release_time) >
-                    MS_TO_US(cfg->click_timeout_ms)) {
+                emit(ctx, cfg, st, BTN_EVT_LONG_START, 0, now_us);
+#if BUTTONLIB_ENABLE_REPEAT
+                st->last_repeat_time = now;
+#endif
+            }
+
+#if BUTTONLIB_ENABLE_REPEAT
+            // Auto-repeat while held
+            if (THRESHOLD(cfg, st, repeat_period) > 0) {
+                if (elapsed(now, st->last_repeat_time) >
+                    THRESHOLD(cfg, st, repeat_period)) {
 
-                    if (!st->suppressed) {
-                        // For CLICK, timestamp = last logical release in series
-                        emit(ctx, cfg, st,
-                             BTN_EVT_CLICK,
-                             st->click_count,
-                             st->last_release_time);
+                    // Increment with saturation at 0xFF to avoid wraparound
+                    if (st->hold_repeat_count < 0xFF) {
+                        st->hold_repeat_count++;
                     }
 
-                    st->click_count       = 0;
-                    st->hold_repeat_count = 0;
+                    emit(ctx, cfg, st,
+                         BTN_EVT_LONG_HOLD,
+                         st->hold_repeat_count,
+                         now_us);
+
+                    st->last_repeat_time = now;
                 }
             }
+#endif
+        }
+#endif
+    } else {
+        /* == IDLE (not logically pressed) == */
+
+#if BUTTONLIB_ENABLE_MULTICLICK
+        // Check click timeout for accumulated short presses
+        if (st->click_count > 0 &&
+            st->click_count != LONG_PRESS_ACTIVE) {
+
+            if (elapsed(now, st->last_release_time) >
+                THRESHOLD(cfg, st, click_timeout)) {
+
+                if (!is_suppressed(st)) {
+                    // For CLICK, timestamp = last logical release in series
+                    emit(ctx, cfg, st,
+                         BTN_EVT_CLICK,
+                         st->click_count,
+                         expand_time(now_us, st->last_release_time));
+                }
 
-            // Reset long-press marker if still set (cleanup)
-            if (st->click_count == LONG_PRESS_ACTIVE) {
                 st->click_count       = 0;
+#if BUTTONLIB_ENABLE_REPEAT
                 st->hold_repeat_count = 0;
+#endif
             }
         }
+#endif
+
+#if BUTTONLIB_ENABLE_LONGPRESS
+        // Reset long-press marker if still set (cleanup)
+        if (st->click_count == LONG_PRESS_ACTIVE) {
+            st->click_count       = 0;
+#if BUTTONLIB_ENABLE_REPEAT
+            st->hold_repeat_count = 0;
+#endif
+        }
+#endif
     }
+
+    schedule(cfg, st);
 }
 
-bool btn_pop_event(btn_context_t *ctx, btn_event_t *evt) {
-    if (!ctx || !evt) return false;
-    if (!ctx->queue || ctx->queue_size == 0) return false;
-    if (ctx->head == ctx->tail) return false;
+/**
+ * True if the button has no pending debounce, hold or click timer, i.e.
+ * step_button() would be a no-op until its raw input changes.
+ */
+static inline bool button_idle(const btn_state_t *st) {
+    return !st->has_due;
+}
 
-    *evt = ctx->queue[ctx->tail];
-    ctx->tail = (ctx->tail + 1) % ctx->queue_size;
+/** Fold the deadline of a button into the cached earliest deadline. */
+static inline void note_due(btn_context_t *ctx, const btn_state_t *st, uint64_t ref_us) {
+    if (!st->has_due) return;
 
-    return true;
+    uint64_t d = expand_due(ref_us, st->due);
+    if (d < ctx->next_due) {
+        ctx->next_due = d;
+    }
 }
 
-size_t btn_get_dropped_events(const btn_context_t *ctx) {
-    if (!ctx) return 0;
-    return ctx->dropped_events;
+/**
+ * True if step_button() has nothing to do at now for an unchanged input:
+ * no timer at all, or the cached deadline is still in the future.
+ */
+static inline bool button_waiting(const btn_state_t *st, btn_time_t now) {
+    return !st->has_due || time_before(now, st->due);
 }
 
-bool btn_is_pressed(btn_context_t *ctx, uint8_t btn_id) {
-    if (!ctx) return false;
-
-    int i = find_index(ctx, btn_id);
-    if (i < 0) return false;
+/**
+ * Earliest time step_button() has something to do for this button
+ * (ref_us = time of the last update).
+ */
+static uint64_t button_deadline(const btn_config_t *cfg,
+                                const btn_state_t *st,
+                                uint64_t ref_us) {
+    // Bank bits are re-read on every update anyway, so a pending edge only
+    // forces a wake-up for read_fn buttons.
+    if (st->edge_pending && cfg->source != BTN_SRC_BANK) {
+        return 0; // Process as soon as possible
+    }
 
-    btn_state_t *st = ctx->buttons[i].state;
-    if (!st) return false;
+    if (!st->has_due) return BTN_NO_DEADLINE;
 
-    // Suppressed buttons are treated as "not pressed" by the helper API.
-    return (st->logic_state && !st->suppressed);
+    return expand_due(ref_us, st->due);
 }
 
-uint64_t btn_get_duration(btn_context_t *ctx,
-                          uint8_t btn_id,
-                          uint64_t now_us) {
-    if (!ctx) return 0;
+/**
+ * Bit-parallel bank scan.
+ *
+ * changed = snapshot XOR previous snapshot; only bits that changed or are
+ * still busy (pending timers) run the per-button state machine. An idle bank
+ * costs one XOR and one OR on top of its read.
+ */
+static void scan_bank(btn_context_t *ctx,
+                      btn_bank_t *bank,
+                      uint32_t snap,
+                      bool timed,
+                      uint64_t now_us) {
+    uint32_t work = (snap ^ bank->snapshot) | bank->busy_mask;
+    bank->snapshot = snap;
 
-    int i = find_index(ctx, btn_id);
-    if (i < 0) return 0;
+    // A notified edge must be consumed now, not by some later transition.
+    if (bank->edge_notified) {
+        bank->edge_notified = false;
+        work |= bank->used_mask;
+    }
 
-    btn_state_t *st = ctx->buttons[i].state;
-    if (!st) return 0;
+    while (work) {
+        uint8_t  bit  = lowest_bit(work);
+        uint32_t mask = 1UL << bit;
+        work &= work - 1;
 
-    if (!st->logic_state || st->suppressed) {
-        return 0;
+        btn_instance_t     *inst = &ctx->buttons[bank->btn_index[bit]];
+        const btn_config_t *cfg  = inst->config;
+        btn_state_t        *st   = inst->state;
+        bool                raw  = (snap & mask) != 0;
+
+        // Busy but unchanged: nothing to do before the cached deadline.
+        bool waiting = raw == st->raw_state && !st->edge_pending &&
+                       button_waiting(st, (btn_time_t)now_us);
+        if (!waiting) {
+            step_button(ctx, bank->btn_index[bit], cfg, st, raw, timed, now_us);
+        }
+        note_due(ctx, st, now_us);
+
+        if (button_idle(st)) {
+            bank->busy_mask &= ~mask;
+        } else {
+            bank->busy_mask |= mask;
+        }
     }
+}
 
-    // Monotonic difference; 64-bit wraparound is practically unreachable.
-    if (now_us >= st->state_start_time) {
-        return now_us - st->state_start_time;
+static void update_bank(btn_context_t *ctx, btn_bank_t *bank, uint64_t now_us) {
+    if (!bank->used_mask || bank->external) return;
+
+    uint32_t snap = bank->snapshot;
+    if (bank->read_fn) {
+        // One read for the whole bank; active_low handled by a single XOR.
+        snap = (bank->read_fn(bank->arg) ^ bank->invert_mask) & bank->used_mask;
     }
 
-    return 0;
+    scan_bank(ctx, bank, snap, false, now_us);
 }
 
-void btn_suppress_events(btn_context_t *ctx, uint8_t btn_id) {
-    if (!ctx) return;
+/** Earliest deadline among the busy buttons of a bank. */
+static uint64_t bank_deadline(const btn_context_t *ctx,
+                              const btn_bank_t *bank,
+                              uint64_t ref_us) {
+    uint64_t deadline = BTN_NO_DEADLINE;
+    uint32_t busy     = bank->busy_mask;
 
-    int i = find_index(ctx, btn_id);
-    if (i < 0) return;
+    while (busy) {
+        const btn_instance_t *inst = &ctx->buttons[bank->btn_index[lowest_bit(busy)]];
+        busy &= busy - 1;
+
+        uint64_t d = button_deadline(inst->config, inst->state, ref_us);
+        if (d < deadline) {
+            deadline = d;
+        }
+    }
+
+    return deadline;
+}
+
+/**
+ * Rows sharing two or more pressed columns with another row. Only rows with
+ * at least two pressed keys can take part in a ghost rectangle.
+ */
+static uint32_t ghost_rows(const uint32_t *cols, uint8_t rows) {
+    uint32_t ghosted = 0;
+
+    for (uint8_t a = 0; a < rows; a++) {
+        if (!(cols[a] & (cols[a] - 1))) continue;
+
+        for (uint8_t b = a + 1; b < rows; b++) {
+            uint32_t shared = cols[a] & cols[b];
+            if (shared & (shared - 1)) {
+                ghosted |= (1UL << a) | (1UL << b);
+            }
+        }
+    }
+
+    return ghosted;
+}
+
+/**
+ * Matrix scan: one select and one read per row, then ghosting check over
+ * the whole matrix, then the regular bank scan for every row.
+ */
+static void update_matrix(btn_context_t *ctx, btn_matrix_t *m, uint64_t now_us) {
+    uint32_t cols[BTN_MATRIX_MAX_ROWS];
+    uint32_t invert = m->active_low ? m->col_mask : 0;
+
+    for (uint8_t r = 0; r < m->rows; r++) {
+        m->select_fn(m->arg, r);
+        cols[r] = (m->read_fn(m->arg) ^ invert) & m->col_mask;
+    }
+
+    m->ghost_rows = ghost_rows(cols, m->rows);
+    if (m->ghost_rows) {
+        m->ghost_scans++;
+    }
+
+    for (uint8_t r = 0; r < m->rows; r++) {
+        btn_bank_t *bank = &ctx->banks[m->first_bank + r];
+        uint32_t    snap = cols[r] & bank->used_mask;
+
+        // Ambiguous row: accept releases only, keep new presses out.
+        if (m->ghost_rows & (1UL << r)) {
+            snap &= bank->snapshot;
+        }
+
+        if (bank->used_mask) {
+            scan_bank(ctx, bank, snap, false, now_us);
+        }
+    }
+}
+
+/**
+ * Combo engine: one mask compare per combo against the logical state mask.
+ */
+static void update_combos(btn_context_t *ctx, uint64_t now_us) {
+    btn_time_t now = (btn_time_t)now_us;
+
+    for (size_t c = 0; c < ctx->combo_count; c++) {
+        const btn_combo_t *combo = &ctx->combos[c];
+        btn_combo_state_t *cs    = &ctx->combo_states[c];
+
+        if ((ctx->pressed_mask & combo->members) != combo->members) {
+            cs->active = false;
+            cs->fired  = false;
+            continue;
+        }
+
+        if (!cs->active) {
+            cs->active = true;
+            cs->since  = now;
+        }
+
+        if (cs->fired) continue;
+
+        if (elapsed(now, cs->since) <= MS_TO_US(combo->hold_ms)) {
+            uint64_t d = expand_time(now_us, cs->since) + MS_TO_US(combo->hold_ms) + 1;
+            if (d < ctx->next_due) {
+                ctx->next_due = d;
+            }
+            continue;
+        }
+
+        cs->fired = true;
+
+#if BUTTONLIB_ENABLE_SUPPRESS
+        if (combo->suppress) {
+            for (uint32_t m = combo->members; m; m &= m - 1) {
+                btn_suppress_events_idx(ctx, lowest_bit(m));
+            }
+        }
+#endif
+
+        btn_event_t evt = {
+            .btn_id = combo->id,
+            .type   = BTN_EVT_COMBO,
+            .clicks = 0,
+            .timestamp = now_us
+        };
+        deliver(ctx, NULL, evt);
+    }
+}
+
+/**
+ * Rebuild the cached earliest deadline from all buttons and combos. Used by
+ * paths outside btn_update() that can move or clear the current minimum;
+ * note_due() alone could only ever lower it.
+ */
+static void rebuild_due(btn_context_t *ctx) {
+    uint64_t ref_us = ctx->last_update_us;
+    ctx->next_due   = BTN_NO_DEADLINE;
+
+    for (size_t i = 0; i < ctx->btn_count; i++) {
+        if (ctx->buttons[i].config && ctx->buttons[i].state) {
+            note_due(ctx, ctx->buttons[i].state, ref_us);
+        }
+    }
+
+    for (size_t c = 0; c < ctx->combo_count; c++) {
+        const btn_combo_state_t *cs = &ctx->combo_states[c];
+        if (!cs->active || cs->fired) continue;
+
+        uint64_t d = expand_time(ref_us, cs->since) + MS_TO_US(ctx->combos[c].hold_ms) + 1;
+        if (d < ctx->next_due) {
+            ctx->next_due = d;
+        }
+    }
+}
+
+/**
+ * Gesture matcher. A step key packs btn_id, type and (CLICK only) clicks;
+ * the sorted alphabet maps an event to its DFA column by binary search.
+ */
+static inline uint32_t gesture_key(uint8_t btn_id, uint8_t type, uint8_t clicks) {
+    return ((uint32_t)btn_id << 16) | ((uint32_t)type << 8)
+         | (type == BTN_EVT_CLICK ? clicks : 0u);
+}
+
+static int gesture_symbol(const btn_gesture_engine_t *eng, uint32_t key) {
+    size_t lo = 0, hi = eng->symbol_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (eng->symbols[mid] < key) lo = mid + 1;
+        else                         hi = mid;
+    }
+    return (lo < eng->symbol_count && eng->symbols[lo] == key) ? (int)lo : -1;
+}
+
+static void update_gesture(btn_context_t *ctx, const btn_event_t *evt) {
+    btn_gesture_engine_t *eng = ctx->gestures;
+
+    int sym = gesture_symbol(eng, gesture_key(evt->btn_id, (uint8_t)evt->type, evt->clicks));
+    if (sym < 0) return;    // Not a step of any gesture
+
+    // CLICK is stamped with its release, so timestamps may step back a little.
+    uint64_t t_us = btn_event_time_us(evt, ctx->last_update_us);
+    if (t_us > eng->last_us) {
+        if (eng->state && eng->gap_us && t_us - eng->last_us > eng->gap_us) {
+            eng->state = 0;
+        }
+        eng->last_us = t_us;
+    }
+
+    uint8_t s = eng->next[eng->state][sym];
+    uint8_t m = eng->match[s] ? s : eng->output[s];
+    eng->state = m ? 0 : s;
+
+    // Longest match first, then gestures that are suffixes of it.
+    for (; m; m = eng->output[m]) {
+        btn_event_t g = {
+            .btn_id = eng->ids[eng->match[m] - 1],
+            .type   = BTN_EVT_GESTURE,
+            .clicks = 0,
+            .timestamp = evt->timestamp
+        };
+        deliver(ctx, NULL, g);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Public API                                                                */
+/* -------------------------------------------------------------------------- */
+
+bool btn_init(btn_context_t *ctx,
+              btn_instance_t *buttons,
+              size_t count,
+              btn_event_t *queue,
+              size_t q_size) {
+    if (!ctx || !buttons) return false;
+
+    memset(ctx, 0, sizeof(btn_context_t));
+    memset(buttons, 0, count * sizeof(btn_instance_t));
+    ctx->buttons   = buttons;
+    ctx->btn_count = count;
+    ctx->queue     = queue;
+    ctx->queue_size = q_size;
+    ctx->next_due   = BTN_NO_DEADLINE;
+
+    // Power-of-two queues use masking instead of modulo.
+    if (q_size > 1 && (q_size & (q_size - 1)) == 0) {
+        ctx->queue_mask = q_size - 1;
+    }
+
+    return true;
+}
+
+void btn_setup(btn_context_t *ctx,
+               uint8_t index,
+               const btn_config_t *cfg,
+               btn_state_t *st) {
+    if (!ctx || index >= ctx->btn_count || !st) return;
+
+    memset(st, 0, sizeof(btn_state_t));
+    if (index < 32) ctx->pressed_mask &= ~(1UL << index);
+
+    // Release the bank bit / polled slot of a previous configuration.
+    if (is_polled(ctx->buttons[index].config)) ctx->polled_count--;
+    bank_unregister(ctx, ctx->buttons[index].config);
+
+    // Validate configuration: read_fn must be non-null (or a valid bank bit).
+    bool valid = false;
+    if (cfg) {
+        valid = (cfg->source == BTN_SRC_BANK) ? bank_register(ctx, index, cfg)
+                                              : (cfg->read_fn != NULL);
+    }
+
+    if (!valid) {
+        ctx->buttons[index].config = NULL;
+        ctx->buttons[index].state  = NULL;
+        return;
+    }
+
+    load_thresholds(st, cfg);
+
+    ctx->buttons[index].config = cfg;
+    ctx->buttons[index].state  = st;
+    if (is_polled(cfg)) ctx->polled_count++;
+
+    if (ctx->id_map) {
+        ctx->id_map[cfg->id] = index;
+    }
+}
+
+bool btn_setup_table(btn_context_t *ctx,
+                     const btn_config_t *configs,
+                     btn_state_t *states,
+                     size_t count) {
+    if (!ctx || !configs || !states || count > ctx->btn_count) return false;
+    if (count > 256) return false; // Indices are stored as uint8_t
+
+    // Release what a previous setup of these slots registered first, so a
+    // bit moving to a lower index is not seen as taken.
+    for (size_t i = 0; i < count; i++) {
+        btn_instance_t *inst = &ctx->buttons[i];
+
+        if (is_polled(inst->config)) ctx->polled_count--;
+        bank_unregister(ctx, inst->config);
+        if (i < 32) ctx->pressed_mask &= ~(1UL << i);
+
+        inst->config = NULL;
+        inst->state  = NULL;
+    }
+
+    memset(states, 0, count * sizeof(btn_state_t));
+
+    bool all_valid = true;
+
+    for (size_t i = 0; i < count; i++) {
+        const btn_config_t *cfg = &configs[i];
+        btn_instance_t     *inst = &ctx->buttons[i];
+
+        bool valid = (cfg->source == BTN_SRC_BANK) ? bank_register(ctx, (uint8_t)i, cfg)
+                                                   : (cfg->read_fn != NULL);
+        if (!valid) {
+            inst->config = NULL;
+            inst->state  = NULL;
+            all_valid    = false;
+            continue;
+        }
+
+        load_thresholds(&states[i], cfg);
+
+        inst->config = cfg;
+        inst->state  = &states[i];
+        if (is_polled(cfg)) ctx->polled_count++;
+    }
+
+    if (ctx->id_map) {
+        btn_set_id_map(ctx, ctx->id_map);
+    }
+
+    return all_valid;
+}
+
+bool btn_reconfigure(btn_context_t *ctx, uint8_t index, const btn_config_t *cfg) {
+    if (!ctx || index >= ctx->btn_count) return false;
+
+    btn_instance_t *inst = &ctx->buttons[index];
+    if (!inst->config || !inst->state) return false;
+
+    if (cfg && cfg != inst->config) {
+        // Input wiring must stay valid; the running state is kept as is.
+        // Checked before anything is unwired, so a failure leaves no trace.
+        if (cfg->source != BTN_SRC_BANK && !cfg->read_fn) return false;
+        if (cfg->source == BTN_SRC_BANK && !bank_slot_free(ctx, index, cfg)) return false;
+
+        bank_unregister(ctx, inst->config);
+        if (cfg->source == BTN_SRC_BANK) {
+            bank_register(ctx, index, cfg);
+
+            // Keep the snapshot in step with the running state, or the
+            // next sample would not look like a change of the held input.
+            if (inst->state->raw_state) {
+                ctx->banks[cfg->bank].snapshot |= 1UL << cfg->bank_bit;
+            }
+        }
+
+        if (is_polled(inst->config)) ctx->polled_count--;
+        if (is_polled(cfg))          ctx->polled_count++;
+
+        inst->config = cfg;
+        if (ctx->id_map) {
+            ctx->id_map[cfg->id] = index;
+        }
+    }
+
+    load_thresholds(inst->state, inst->config);
+    schedule(inst->config, inst->state);
+    rebuild_due(ctx);
+    mark_busy(ctx, inst->config);
+
+    return true;
+}
+
+void btn_set_id_map(btn_context_t *ctx, uint8_t *map) {
+    if (!ctx) return;
+
+    ctx->id_map = map;
+    if (!map) return;
+
+    memset(map, BTN_INDEX_NONE, BTN_ID_MAP_SIZE);
+
+    // Walk backwards so the lowest index wins for duplicate IDs,
+    // matching the linear scan.
+    for (size_t i = ctx->btn_count; i-- > 0;) {
+        if (ctx->buttons[i].config) {
+            map[ctx->buttons[i].config->id] = (uint8_t)i;
+        }
+    }
+}
+
+bool btn_init_banks(btn_context_t *ctx, btn_bank_t *banks, size_t count) {
+    if (!ctx || !banks) return false;
+
+    memset(banks, 0, count * sizeof(btn_bank_t));
+    ctx->banks      = banks;
+    ctx->bank_count = count;
+
+    return true;
+}
+
+void btn_setup_bank(btn_context_t *ctx,
+                    uint8_t index,
+                    btn_bank_read_fn_t read_fn,
+                    void *arg) {
+    if (!ctx || !ctx->banks || index >= ctx->bank_count) return;
+
+    // Masks are owned by btn_setup(); only the reader is replaced here.
+    ctx->banks[index].read_fn = read_fn;
+    ctx->banks[index].arg     = arg;
+}
+
+void btn_feed_bank(btn_context_t *ctx, uint8_t index, uint32_t levels, uint64_t t_us) {
+    btn_feed_bank_samples(ctx, index, &levels, 1, t_us, 0);
+}
+
+size_t btn_feed_bank_samples(btn_context_t *ctx,
+                             uint8_t index,
+                             const uint32_t *samples,
+                             size_t count,
+                             uint64_t t0_us,
+                             uint32_t period_ns) {
+    if (!ctx || !ctx->banks || index >= ctx->bank_count || !samples) return 0;
+
+    btn_bank_t *bank = &ctx->banks[index];
+    if (!bank->used_mask || bank->external) return 0;
+
+    // Only samples that change the bank or reach a pending timer are
+    // processed; runs of identical samples cost one XOR/AND each.
+    uint64_t deadline = bank_deadline(ctx, bank, ctx->last_update_us);
+    size_t   scanned  = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t t    = t0_us + (uint64_t)i * period_ns / 1000u;
+        uint32_t snap = (samples[i] ^ bank->invert_mask) & bank->used_mask;
+
+        if (snap == bank->snapshot && t < deadline) continue;
+
+        // btn_next_deadline() computes from the latest known time.
+        if (t > ctx->last_update_us) {
+            ctx->last_update_us = t;
+        }
+
+        scan_bank(ctx, bank, snap, true, t);
+        deadline = bank_deadline(ctx, bank, t);
+        scanned++;
+    }
+
+    // A deadline met by the samples may have been the cached minimum.
+    if (scanned) {
+        rebuild_due(ctx);
+    }
+
+    return scanned;
+}
+
+bool btn_set_matrices(btn_context_t *ctx, btn_matrix_t *matrices, size_t count) {
+    if (!ctx) return false;
+    if (count && !matrices) return false;
+
+    for (size_t m = 0; m < count; m++) {
+        const btn_matrix_t *mx = &matrices[m];
+        if (!mx->select_fn || !mx->read_fn) return false;
+        if (mx->rows == 0 || mx->rows > BTN_MATRIX_MAX_ROWS) return false;
+        if (!ctx->banks || (size_t)mx->first_bank + mx->rows > ctx->bank_count) return false;
+    }
+
+    // Release the banks of the previous matrices.
+    for (size_t m = 0; m < ctx->matrix_count; m++) {
+        for (uint8_t r = 0; r < ctx->matrices[m].rows; r++) {
+            ctx->banks[ctx->matrices[m].first_bank + r].external = false;
+        }
+    }
+
+    for (size_t m = 0; m < count; m++) {
+        matrices[m].ghost_rows  = 0;
+        matrices[m].ghost_scans = 0;
+        for (uint8_t r = 0; r < matrices[m].rows; r++) {
+            ctx->banks[matrices[m].first_bank + r].external = true;
+        }
+    }
+
+    ctx->matrices     = count ? matrices : NULL;
+    ctx->matrix_count = count;
+
+    return true;
+}
+
+/** Replay pass: raw states come from ctx->replay_levels for every button. */
+static void update_replay(btn_context_t *ctx, uint64_t now_us) {
+    for (size_t i = 0; i < ctx->btn_count; i++) {
+        const btn_config_t *cfg = ctx->buttons[i].config;
+        btn_state_t        *st  = ctx->buttons[i].state;
+        if (!cfg || !st) continue;
+
+        bool raw = (ctx->replay_levels[i >> 5] >> (i & 31)) & 1u;
+
+        if (raw != st->raw_state || !button_waiting(st, (btn_time_t)now_us)) {
+            step_button(ctx, i, cfg, st, raw, false, now_us);
+        }
+        note_due(ctx, st, now_us);
+    }
+}
+
+/** One btn_update() pass over all inputs. */
+static void update_all(btn_context_t *ctx, uint64_t now_us) {
+    ctx->last_update_us = now_us;
+
+    // Rebuilt from every button with a timer during this pass.
+    ctx->edge_notified = false;
+    ctx->next_due      = BTN_NO_DEADLINE;
+
+    if (ctx->replay_levels) {
+        update_replay(ctx, now_us);
+        if (ctx->combo_count) {
+            update_combos(ctx, now_us);
+        }
+        return;
+    }
+
+    /* 0. Matrices: one select + one read per row, fed into the row banks */
+    for (size_t m = 0; m < ctx->matrix_count; m++) {
+        update_matrix(ctx, &ctx->matrices[m], now_us);
+    }
+
+    /* 1. Banks: one read per bank, state machine only for changed/busy bits */
+    for (size_t b = 0; b < ctx->bank_count; b++) {
+        update_bank(ctx, &ctx->banks[b], now_us);
+    }
+
+    /* 2. Buttons with their own read_fn (stop once all of them were seen) */
+    size_t polled = ctx->polled_count;
+
+    for (size_t i = 0; polled > 0 && i < ctx->btn_count; i++) {
+        const btn_config_t *cfg = ctx->buttons[i].config;
+        btn_state_t        *st  = ctx->buttons[i].state;
+        if (!is_polled(cfg) || !st) continue; // Bank buttons handled above
+        polled--;
+
+        // No edge and no timer due yet: only an input change can give work.
+        bool waiting = !st->edge_pending && button_waiting(st, (btn_time_t)now_us);
+
+        // Edge mode: nothing can change until an edge is notified.
+        if (ctx->edge_mode && waiting) {
+            note_due(ctx, st, now_us);
+            continue;
+        }
+
+        bool raw = cfg->read_fn(cfg->hw_arg);
+        if (cfg->active_low) {
+            raw = !raw;
+        }
+
+        if (waiting && raw == st->raw_state) {
+            note_due(ctx, st, now_us);
+            continue;
+        }
+
+        step_button(ctx, i, cfg, st, raw, false, now_us);
+        note_due(ctx, st, now_us);
+    }
+
+    /* 3. Combos */
+    if (ctx->combo_count) {
+        update_combos(ctx, now_us);
+    }
+}
+
+void btn_update(btn_context_t *ctx, uint64_t now_us) {
+    if (!ctx) return;
+
+    btn_stats_t *stats = ctx->stats;
+    if (!stats || !ctx->stats_clock) {
+        update_all(ctx, now_us);
+        if (stats) count_up(&stats->updates);
+        return;
+    }
+
+    uint32_t t0 = ctx->stats_clock(ctx->stats_clock_arg);
+    update_all(ctx, now_us);
+    uint32_t d  = ctx->stats_clock(ctx->stats_clock_arg) - t0;
+
+    count_up(&stats->updates);
+    stats->update_total += d;
+    if (d > stats->update_max) {
+        stats->update_max = d;
+    }
+}
+
+void btn_set_stats(btn_context_t *ctx,
+                   btn_stats_t *stats,
+                   uint32_t bucket_us,
+                   btn_clock_fn_t clock_fn,
+                   void *clock_arg) {
+    if (!ctx) return;
+
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+        stats->latency_bucket_us = bucket_us ? bucket_us : 1000;
+    }
+
+    ctx->stats           = stats;
+    ctx->stats_clock     = stats ? clock_fn : NULL;
+    ctx->stats_clock_arg = stats ? clock_arg : NULL;
+}
+
+bool btn_trace_start(btn_context_t *ctx,
+                     btn_trace_t *trace,
+                     uint8_t *buf,
+                     size_t size,
+                     btn_trace_flush_fn_t flush_fn,
+                     void *flush_arg) {
+    if (!ctx || !trace || !buf || size < BTN_TRACE_RECORD_MAX) return false;
+
+    memset(trace, 0, sizeof(*trace));
+    trace->buf       = buf;
+    trace->size      = size;
+    trace->flush_fn  = flush_fn;
+    trace->flush_arg = flush_arg;
+
+    // Records toggle a released start state: log what is already pressed.
+    for (size_t i = 0; i < ctx->btn_count && i < 256; i++) {
+        const btn_state_t *st = ctx->buttons[i].state;
+        if (ctx->buttons[i].config && st && st->raw_state) {
+            trace_edge(trace, i, ctx->last_update_us);
+        }
+    }
+
+    ctx->trace = trace;
+    return true;
+}
+
+void btn_trace_stop(btn_context_t *ctx) {
+    if (!ctx || !ctx->trace) return;
+
+    // The end marker carries the stop time, so replays end where recording did.
+    trace_edge(ctx->trace, BTN_TRACE_END, ctx->last_update_us);
+    ctx->trace = NULL;
+}
+
+bool btn_trace_flush(btn_trace_t *trace) {
+    if (!trace) return false;
+    if (trace->len == 0) return true;
+    if (!trace->flush_fn || !trace->flush_fn(trace->flush_arg, trace->buf, trace->len)) {
+        return false;
+    }
+
+    trace->len = 0;
+    return true;
+}
+
+/** Decode the next record header into rp->next_us / next_index. */
+static void replay_fetch(btn_replay_t *rp) {
+    uint64_t delta;
+    uint64_t index;
+
+    rp->has_next = get_varint(rp->data, rp->len, &rp->pos, &delta) &&
+                   get_varint(rp->data, rp->len, &rp->pos, &index) &&
+                   index <= BTN_TRACE_END;
+    if (!rp->has_next) return;
+
+    rp->next_us += delta;
+    if (index == BTN_TRACE_END) {
+        rp->has_next = false;
+        rp->end_us   = rp->next_us;
+        return;
+    }
+    rp->next_index = (uint8_t)index;
+}
+
+bool btn_replay_init(btn_replay_t *rp, btn_context_t *ctx, const uint8_t *data, size_t len) {
+    if (!rp || !ctx || (!data && len)) return false;
+
+    memset(rp, 0, sizeof(*rp));
+    rp->data   = data;
+    rp->len    = len;
+    rp->end_us = BTN_NO_DEADLINE;
+    replay_fetch(rp);
+
+    ctx->replay_levels = rp->levels;
+    return true;
+}
+
+bool btn_replay_step(btn_context_t *ctx, btn_replay_t *rp, uint32_t step_us) {
+    if (!ctx || !rp) return false;
+
+    uint64_t due = btn_next_deadline(ctx);
+    if (!rp->has_next && due == BTN_NO_DEADLINE) return false;
+
+    uint64_t t;
+    if (!rp->started) {
+        t = rp->has_next ? rp->next_us : due;
+    } else if (step_us) {
+        t = rp->now_us + step_us;
+    } else {
+        t = (rp->has_next && rp->next_us < due) ? rp->next_us : due;
+        if (t <= rp->now_us) t = rp->now_us + 1;
+    }
+
+    // Nothing past the recorded stop time (e.g. auto-repeat of a held key).
+    if (t > rp->end_us) return false;
+
+    while (rp->has_next && rp->next_us <= t) {
+        rp->levels[rp->next_index >> 5] ^= 1u << (rp->next_index & 31);
+        replay_fetch(rp);
+    }
+
+    btn_update(ctx, t);
+    rp->now_us  = t;
+    rp->started = true;
+    return true;
+}
+
+bool btn_get_stats(const btn_context_t *ctx, btn_stats_t *out) {
+    if (!ctx || !ctx->stats || !out) return false;
+
+    *out = *ctx->stats;
+    out->update_avg = out->updates ? (uint32_t)(out->update_total / out->updates) : 0;
+    return true;
+}
+
+bool btn_set_combos(btn_context_t *ctx,
+                    const btn_combo_t *combos,
+                    btn_combo_state_t *states,
+                    size_t count) {
+    if (!ctx) return false;
+    if (count && (!combos || !states)) return false;
+
+    if (count) {
+        memset(states, 0, count * sizeof(btn_combo_state_t));
+    }
+
+    ctx->combos       = count ? combos : NULL;
+    ctx->combo_states = count ? states : NULL;
+    ctx->combo_count  = count;
+
+    return true;
+}
+
+bool btn_gesture_compile(btn_gesture_engine_t *eng,
+                         const btn_gesture_t *gestures,
+                         size_t count,
+                         uint16_t gap_ms) {
+    if (!eng || !gestures || count == 0 || count >= BTN_GESTURE_MAX_STATES) return false;
+
+    memset(eng, 0, sizeof(btn_gesture_engine_t));
+    eng->gap_us = (uint32_t)gap_ms * 1000u;
+
+    /* 1. Alphabet: distinct step keys, sorted */
+    for (size_t g = 0; g < count; g++) {
+        if (!gestures[g].steps || gestures[g].length == 0) return false;
+
+        for (size_t k = 0; k < gestures[g].length; k++) {
+            const btn_gesture_step_t *step = &gestures[g].steps[k];
+            uint32_t key = gesture_key(step->btn_id, step->type, step->clicks);
+            if (gesture_symbol(eng, key) >= 0) continue;
+            if (eng->symbol_count == BTN_GESTURE_MAX_SYMBOLS) return false;
+
+            size_t pos = eng->symbol_count;
+            while (pos > 0 && eng->symbols[pos - 1] > key) {
+                eng->symbols[pos] = eng->symbols[pos - 1];
+                pos--;
+            }
+            eng->symbols[pos] = key;
+            eng->symbol_count++;
+        }
+    }
+
+    /* 2. Trie of the sequences (state 0 = root, 0 in next[] = no child yet) */
+    eng->state_count = 1;
+    for (size_t g = 0; g < count; g++) {
+        uint8_t s = 0;
+        for (size_t k = 0; k < gestures[g].length; k++) {
+            const btn_gesture_step_t *step = &gestures[g].steps[k];
+            int sym = gesture_symbol(eng, gesture_key(step->btn_id, step->type, step->clicks));
+
+            if (!eng->next[s][sym]) {
+                if (eng->state_count == BTN_GESTURE_MAX_STATES) return false;
+                eng->next[s][sym] = eng->state_count++;
+            }
+            s = eng->next[s][sym];
+        }
+        if (eng->match[s]) return false;    // Same sequence twice
+
+        eng->match[s] = (uint8_t)(g + 1);
+        eng->ids[g]   = gestures[g].id;
+    }
+
+    /* 3. Fallback transitions, breadth first: a missing child of s behaves
+     *    like the same step from the longest proper suffix state of s. */
+    uint8_t fail[BTN_GESTURE_MAX_STATES];
+    uint8_t order[BTN_GESTURE_MAX_STATES];
+    size_t  head = 0, tail = 0;
+
+    for (size_t sym = 0; sym < eng->symbol_count; sym++) {
+        uint8_t c = eng->next[0][sym];
+        if (c) {
+            fail[c] = 0;
+            order[tail++] = c;
+        }
+    }
+
+    while (head < tail) {
+        uint8_t s = order[head++];
+        uint8_t f = fail[s];
+        eng->output[s] = eng->match[f] ? f : eng->output[f];
+
+        for (size_t sym = 0; sym < eng->symbol_count; sym++) {
+            uint8_t c = eng->next[s][sym];
+            if (c) {
+                fail[c] = eng->next[f][sym];
+                order[tail++] = c;
+            } else {
+                eng->next[s][sym] = eng->next[f][sym];
+            }
+        }
+    }
+
+    return true;
+}
+
+void btn_set_gestures(btn_context_t *ctx, btn_gesture_engine_t *eng) {
+    if (!ctx) return;
+
+    if (eng) {
+        eng->state   = 0;
+        eng->last_us = 0;
+    }
+    ctx->gestures = eng;
+}
+
+void btn_set_edge_mode(btn_context_t *ctx, bool enable) {
+    if (!ctx) return;
+    ctx->edge_mode = enable;
+}
+
+void btn_notify_edge(btn_context_t *ctx, uint8_t btn_id, uint64_t now_us) {
+    int i = find_index(ctx, btn_id);
+    if (i < 0) return;
 
     btn_state_t *st = ctx->buttons[i].state;
     if (!st) return;
 
+    st->edge_time    = (btn_time_t)now_us;
+    st->edge_pending = true;
+
+    const btn_config_t *cfg = ctx->buttons[i].config;
+    if (cfg->source != BTN_SRC_BANK) {
+        ctx->edge_notified = true;
+    } else if (bank_slot_valid(ctx, cfg)) {
+        ctx->banks[cfg->bank].edge_notified = true;
+    }
+}
+
+uint64_t btn_next_deadline(const btn_context_t *ctx) {
+    if (!ctx) return BTN_NO_DEADLINE;
+
+    // A read_fn button with a notified edge needs an update right away.
+    if (ctx->edge_notified) return 0;
+
+    // Cached by btn_update() / btn_feed_bank*(), no per-button scan here.
+    return ctx->next_due;
+}
+
+bool btn_set_queue_spsc(btn_context_t *ctx, bool enable) {
+    if (!ctx) return false;
+    if (enable && (!ctx->queue || ctx->queue_mask == 0)) return false;
+
+    ctx->queue_spsc = enable;
+    return true;
+}
+
+bool btn_set_overflow_policy(btn_context_t *ctx,
+                             btn_overflow_policy_t policy,
+                             bool coalesce_hold) {
+    if (!ctx || policy > BTN_OVERFLOW_PRIORITY) return false;
+
+    ctx->overflow_policy = policy;
+    ctx->coalesce_hold   = coalesce_hold;
+    return true;
+}
+
+bool btn_set_deferred_dispatch(btn_context_t *ctx, btn_event_t *buf, size_t size) {
+    if (!ctx) return false;
+    if (buf && size < 2) return false;
+
+    ctx->pending      = buf;
+    ctx->pending_size = buf ? size : 0;
+    ctx->pending_mask = (buf && (size & (size - 1)) == 0) ? size - 1 : 0;
+    ctx->pending_head = 0;
+    ctx->pending_tail = 0;
+
+    return true;
+}
+
+size_t btn_dispatch(btn_context_t *ctx) {
+    if (!ctx || !ctx->pending) return 0;
+
+    size_t      count = 0;
+    btn_event_t evt;
+
+    while (pending_pop(ctx, &evt)) {
+        count++;
+
+        // COMBO / GESTURE IDs are not button IDs: no per-button callback.
+        bool own = evt.type != BTN_EVT_COMBO && evt.type != BTN_EVT_GESTURE;
+        int  i   = own ? find_index(ctx, evt.btn_id) : -1;
+        const btn_config_t *cfg = (i >= 0) ? ctx->buttons[i].config : NULL;
+
+        if (cfg && cfg->callback && cfg->callback(&evt, cfg->cb_user_data)) {
+            // Callback consumed the event.
+            continue;
+        }
+
+        push_event(ctx, evt);
+    }
+
+    return count;
+}
+
+uint64_t btn_event_time_us(const btn_event_t *evt, uint64_t ref_us) {
+    if (!evt) return 0;
+#if BUTTONLIB_COMPACT_EVENTS
+    return ref_us - (uint32_t)((uint32_t)ref_us - evt->timestamp);
+#else
+    (void)ref_us;
+    return evt->timestamp;
+#endif
+}
+
+bool btn_pop_event(btn_context_t *ctx, btn_event_t *evt) {
+    if (!ctx || !evt) return false;
+    if (!ctx->queue || ctx->queue_size == 0) return false;
+
+    if (ctx->queue_spsc) {
+        // The consumer only ever writes tail.
+        size_t tail = ctx->tail;
+        if (tail == LOAD_ACQUIRE(&ctx->head)) return false;
+
+        *evt = ctx->queue[tail];
+        STORE_RELEASE(&ctx->tail, queue_next(ctx, tail));
+        return true;
+    }
+
+    if (ctx->head == ctx->tail) return false;
+
+    *evt = ctx->queue[ctx->tail];
+    ctx->tail = queue_next(ctx, ctx->tail);
+
+    return true;
+}
+
+size_t btn_pop_events(btn_context_t *ctx, btn_event_t *buf, size_t max) {
+    if (!ctx || !buf || max == 0) return 0;
+    if (!ctx->queue || ctx->queue_size == 0) return 0;
+
+    size_t tail;
+    size_t count = queue_pending(ctx, &tail);
+    if (count > max) count = max;
+    if (count == 0) return 0;
+
+    // At most two contiguous spans: [tail, end) and [0, rest).
+    size_t first = ctx->queue_size - tail;
+    if (first > count) first = count;
+
+    memcpy(buf, &ctx->queue[tail], first * sizeof(btn_event_t));
+    memcpy(buf + first, ctx->queue, (count - first) * sizeof(btn_event_t));
+
+    queue_release(ctx, tail, count);
+    return count;
+}
+
+size_t btn_peek_events(btn_context_t *ctx, const btn_event_t **events) {
+    if (!ctx || !events) return 0;
+
+    *events = NULL;
+    if (!ctx->queue || ctx->queue_size == 0) return 0;
+
+    size_t tail;
+    size_t count = queue_pending(ctx, &tail);
+    if (count == 0) return 0;
+
+    // Only the contiguous part up to the end of the ring.
+    size_t span = ctx->queue_size - tail;
+    if (span > count) span = count;
+
+    *events = &ctx->queue[tail];
+    return span;
+}
+
+void btn_commit_events(btn_context_t *ctx, size_t count) {
+    if (!ctx || !ctx->queue || ctx->queue_size == 0 || count == 0) return;
+
+    size_t tail;
+    size_t pending = queue_pending(ctx, &tail);
+    if (count > pending) count = pending;
+
+    queue_release(ctx, tail, count);
+}
+
+uint64_t btn_update_shards(btn_shard_t *shards, size_t count, uint64_t now_us) {
+    uint64_t next = BTN_NO_DEADLINE;
+    if (!shards) return next;
+
+    for (size_t i = 0; i < count; i++) {
+        btn_shard_t *sh = &shards[i];
+        if (!sh->ctx) continue;
+
+        if (now_us >= sh->next_us) {
+            btn_update(sh->ctx, now_us);
+
+            // No catch-up: the next update is one period after this one.
+            sh->next_us = now_us + sh->period_us;
+        }
+
+        if (sh->next_us < next) {
+            next = sh->next_us;
+        }
+    }
+
+    return next;
+}
+
+bool btn_merge_pop(btn_context_t *const *shards, size_t count,
+                   uint64_t until_us, btn_event_t *evt) {
+    if (!shards || !evt) return false;
+
+    btn_context_t     *best      = NULL;
+    const btn_event_t *best_head = NULL;
+
+    for (size_t i = 0; i < count; i++) {
+        const btn_event_t *head;
+        if (btn_peek_events(shards[i], &head) == 0) continue;
+
+        if (event_not_after(head, until_us) &&
+            (!best_head || event_before(head, best_head))) {
+            best      = shards[i];
+            best_head = head;
+        }
+    }
+
+    if (!best) return false;
+
+    // The head entry is not touched by the producer until it is committed.
+    *evt = *best_head;
+    btn_commit_events(best, 1);
+
+    return true;
+}
+
+size_t btn_get_dropped_events(const btn_context_t *ctx) {
+    if (!ctx) return 0;
+    return ctx->dropped_events;
+}
+
+int btn_find_index(btn_context_t *ctx, uint8_t btn_id) {
+    return find_index(ctx, btn_id);
+}
+
+bool btn_is_pressed_idx(btn_context_t *ctx, size_t index) {
+    if (!ctx || index >= ctx->btn_count) return false;
+
+    btn_state_t *st = ctx->buttons[index].state;
+    if (!st) return false;
+
+    // Suppressed buttons are treated as "not pressed" by the helper API.
+    return (st->logic_state && !is_suppressed(st));
+}
+
+uint64_t btn_get_duration_idx(btn_context_t *ctx,
+                              size_t index,
+                              uint64_t now_us) {
+    if (!ctx || index >= ctx->btn_count) return 0;
+
+    btn_state_t *st = ctx->buttons[index].state;
+    if (!st) return 0;
+
+    if (!st->logic_state || is_suppressed(st)) {
+        return 0;
+    }
+
+#if BUTTONLIB_COMPACT_STATE
+    // Wrap-safe 32-bit difference (valid for holds up to ~71 minutes).
+    return elapsed((btn_time_t)now_us, st->state_start_time);
+#else
+    // Monotonic difference; 64-bit wraparound is practically unreachable.
+    if (now_us >= st->state_start_time) {
+        return now_us - st->state_start_time;
+    }
+
+    return 0;
+#endif
+}
+
+#if BUTTONLIB_ENABLE_SUPPRESS
+void btn_suppress_events_idx(btn_context_t *ctx, size_t index) {
+    if (!ctx || index >= ctx->btn_count) return;
+
+    btn_state_t *st = ctx->buttons[index].state;
+    if (!st) return;
+
     // Suppress all further events until the next logical press (DOWN).
     st->suppressed        = true;
+#if BUTTONLIB_ENABLE_MULTICLICK || BUTTONLIB_ENABLE_LONGPRESS
     st->click_count       = 0;
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
     st->hold_repeat_count = 0;
+#endif
+
+    schedule(ctx->buttons[index].config, st);
+    rebuild_due(ctx);
+    mark_busy(ctx, ctx->buttons[index].config);
 
     // We intentionally do not modify logic_state or timing fields here:
     //  - no CLICK/UP/LONG_* will be emitted while suppressed,
     //  - physical release after suppression does not produce UP,
     //  - a new logical press (DOWN) clears suppression and starts a new series.
 }
+#endif
+
+bool btn_is_pressed(btn_context_t *ctx, uint8_t btn_id) {
+    int i = find_index(ctx, btn_id);
+    if (i < 0) return false;
+
+    return btn_is_pressed_idx(ctx, (size_t)i);
+}
+
+uint64_t btn_get_duration(btn_context_t *ctx,
+                          uint8_t btn_id,
+                          uint64_t now_us) {
+    int i = find_index(ctx, btn_id);
+    if (i < 0) return 0;
+
+    return btn_get_duration_idx(ctx, (size_t)i, now_us);
+}
+
+#if BUTTONLIB_ENABLE_SUPPRESS
+void btn_suppress_events(btn_context_t *ctx, uint8_t btn_id) {
+    int i = find_index(ctx, btn_id);
+    if (i < 0) return;
+
+    btn_suppress_events_idx(ctx, (size_t)i);
+}
+#endif
@@ -0,0 +1,103 @@
+#include "buttonlib_dma.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/structs/sio.h"
+#include "pico/time.h"
+
+#define DMA_ENDLESS 0xFFFFFFFFu
+
+/** Samples written by the channel so far (free-running, wraps at 2^32). */
+static inline uint32_t captured(const btn_dma_t *drv) {
+    return DMA_ENDLESS - dma_channel_hw_addr(drv->dma_chan)->transfer_count;
+}
+
+bool btn_dma_init(btn_dma_t *drv,
+                  uint32_t *buf,
+                  uint8_t ring_bits,
+                  uint32_t sample_hz,
+                  uint8_t bank) {
+    if (!drv || !buf || ring_bits < 3 || ring_bits > 15 || sample_hz == 0) return false;
+    if ((uintptr_t)buf & ((1u << ring_bits) - 1u)) return false; // Ring must be aligned
+
+    // Pacing timer: rate = clk_sys * 1 / div.
+    uint32_t clk = clock_get_hz(clk_sys);
+    uint32_t div = clk / sample_hz;
+    if (div == 0 || div > 0xFFFF) return false;
+
+    int chan  = dma_claim_unused_channel(false);
+    if (chan < 0) return false;
+    int timer = dma_claim_unused_timer(false);
+    if (timer < 0) {
+        dma_channel_unclaim((uint)chan);
+        return false;
+    }
+
+    drv->buf       = buf;
+    drv->size      = (1u << ring_bits) / sizeof(uint32_t);
+    drv->ring_bits = ring_bits;
+    drv->dma_chan  = (uint)chan;
+    drv->dma_timer = (uint)timer;
+    drv->period_ns = (uint32_t)((uint64_t)div * 1000000000u / clk);
+    drv->consumed  = 0;
+    drv->bank      = bank;
+    drv->overruns  = 0;
+
+    dma_timer_set_fraction(drv->dma_timer, 1, (uint16_t)div);
+
+    dma_channel_config c = dma_channel_get_default_config(drv->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, ring_bits);       // Wrap the write address
+    channel_config_set_dreq(&c, dma_get_timer_dreq(drv->dma_timer));
+
+    dma_channel_configure(drv->dma_chan, &c,
+                          buf, &sio_hw->gpio_in,
+                          DMA_ENDLESS, true);
+
+    return true;
+}
+
+size_t btn_dma_service(btn_dma_t *drv, btn_context_t *ctx) {
+    if (!drv || !ctx) return 0;
+
+    // Anchor: the newest sample was taken (at most one period) before now.
+    uint32_t total  = captured(drv);
+    uint64_t now_us = time_us_64();
+
+    uint32_t count = total - drv->consumed;
+    if (count == 0) return 0;
+
+    // Keep one slot of margin: the channel may be writing the oldest one.
+    if (count > drv->size - 1) {
+        drv->overruns += count - (drv->size - 1);
+        drv->consumed  = total - (drv->size - 1);
+        count          = drv->size - 1;
+    }
+
+    uint64_t span_us = (uint64_t)(count - 1) * drv->period_ns / 1000u;
+    uint64_t t0_us   = now_us > span_us ? now_us - span_us : 0;
+
+    // Up to two contiguous spans of the ring.
+    uint32_t start = drv->consumed & (drv->size - 1);
+    uint32_t first = drv->size - start;
+    if (first > count) first = count;
+
+    btn_feed_bank_samples(ctx, drv->bank, &drv->buf[start], first, t0_us, drv->period_ns);
+    if (count > first) {
+        uint64_t t1_us = t0_us + (uint64_t)first * drv->period_ns / 1000u;
+        btn_feed_bank_samples(ctx, drv->bank, drv->buf, count - first, t1_us, drv->period_ns);
+    }
+
+    drv->consumed += count;
+
+    // Re-arm long before the transfer count runs out (~24 h at 50 kHz).
+    if (total > 0x80000000u) {
+        dma_channel_abort(drv->dma_chan);
+        drv->consumed = 0;
+        dma_channel_set_write_addr(drv->dma_chan, drv->buf, false);
+        dma_channel_set_trans_count(drv->dma_chan, DMA_ENDLESS, true);
+    }
+
+    return count;
+}
@@ -0,0 +1,143 @@
+#include "buttonlib_expander.h"
+#include <string.h>
+
+// The bus state is shared between btn_update() and transfer completion
+// (typically an IRQ), so the claim and request bits are atomic.
+#if defined(__GNUC__)
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define FETCH_OR(p, v)      __atomic_fetch_or((p), (v), __ATOMIC_ACQ_REL)
+#define FETCH_AND(p, v)     __atomic_fetch_and((p), (v), __ATOMIC_ACQ_REL)
+#define TRY_CLAIM(p)        (!__atomic_test_and_set((p), __ATOMIC_ACQUIRE))
+#else
+#error "buttonlib_expander requires GCC/Clang atomic builtins"
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*  Internal helpers                                                          */
+/* -------------------------------------------------------------------------- */
+
+static void transfer_done(void *done_arg, bool ok);
+
+/** Next requested expander at or after the round-robin cursor. */
+static uint8_t pick_pending(const btn_expander_bus_t *bus, uint32_t pending) {
+    for (size_t n = 0; n < bus->count; n++) {
+        uint8_t i = (uint8_t)((bus->next + n) % bus->count);
+        if (pending & (1UL << i)) return i;
+    }
+    return 0;
+}
+
+/**
+ * Start the next requested transfer if the bus is free. Whoever holds the
+ * bus (caller or completion) picks up requests made in the meantime.
+ */
+static void bus_kick(btn_expander_bus_t *bus) {
+    while (LOAD_ACQUIRE(&bus->pending)) {
+        if (!TRY_CLAIM(&bus->busy)) return; // Current owner will continue
+
+        uint32_t pending = LOAD_ACQUIRE(&bus->pending);
+        if (!pending) {
+            __atomic_clear(&bus->busy, __ATOMIC_RELEASE);
+            continue; // Re-check: a request may have raced the release
+        }
+
+        uint8_t         i   = pick_pending(bus, pending);
+        btn_expander_t *exp = &bus->expanders[i];
+
+        FETCH_AND(&bus->pending, ~(1UL << i));
+        bus->next = (uint8_t)((i + 1) % bus->count);
+
+        if (bus->start_fn(bus->arg, exp->addr,
+                          exp->tx, exp->tx_len,
+                          exp->rx, sizeof(exp->rx),
+                          transfer_done, exp)) {
+            return; // transfer_done() releases the bus
+        }
+
+        exp->errors++;
+        __atomic_clear(&bus->busy, __ATOMIC_RELEASE);
+    }
+}
+
+static void transfer_done(void *done_arg, bool ok) {
+    btn_expander_t     *exp = (btn_expander_t*)done_arg;
+    btn_expander_bus_t *bus = exp->bus;
+
+    if (ok) {
+        STORE_RELEASE(&exp->port, (uint32_t)exp->rx[0] | ((uint32_t)exp->rx[1] << 8));
+        exp->reads++;
+    } else {
+        exp->errors++; // Keep the previous mask
+    }
+
+    __atomic_clear(&bus->busy, __ATOMIC_RELEASE);
+    bus_kick(bus);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Public API                                                                */
+/* -------------------------------------------------------------------------- */
+
+bool btn_expander_bus_init(btn_expander_bus_t *bus,
+                           btn_expander_t *expanders,
+                           size_t count,
+                           btn_xfer_start_fn_t start_fn,
+                           void *arg) {
+    if (!bus || !expanders || !start_fn) return false;
+    if (count == 0 || count > BTN_EXPANDER_MAX) return false;
+
+    memset(bus, 0, sizeof(btn_expander_bus_t));
+    memset(expanders, 0, count * sizeof(btn_expander_t));
+
+    bus->start_fn  = start_fn;
+    bus->arg       = arg;
+    bus->expanders = expanders;
+    bus->count     = count;
+
+    for (size_t i = 0; i < count; i++) {
+        expanders[i].bus   = bus;
+        expanders[i].index = (uint8_t)i;
+    }
+
+    return true;
+}
+
+void btn_expander_setup(btn_expander_bus_t *bus,
+                        uint8_t index,
+                        btn_expander_type_t type,
+                        uint8_t addr,
+                        uint32_t idle) {
+    if (!bus || index >= bus->count) return;
+
+    btn_expander_t *exp = &bus->expanders[index];
+
+    exp->addr = addr;
+    exp->port = idle;
+
+    switch (type) {
+    case BTN_EXP_MCP23017:
+        exp->tx[0]  = 0x12;                 // GPIOA, sequential to GPIOB
+        exp->tx_len = 1;
+        break;
+    case BTN_EXP_MCP23S17:
+        exp->tx[0]  = (uint8_t)(0x41 | ((addr & 0x07) << 1)); // Read opcode
+        exp->tx[1]  = 0x12;
+        exp->tx_len = 2;
+        break;
+    case BTN_EXP_PCF8575:
+    default:
+        exp->tx_len = 0;                    // Plain 2-byte read
+        break;
+    }
+}
+
+uint32_t btn_expander_read(void *arg) {
+    btn_expander_t     *exp = (btn_expander_t*)arg;
+    btn_expander_bus_t *bus = exp->bus;
+
+    FETCH_OR(&bus->pending, 1UL << exp->index);
+    bus_kick(bus);
+
+    return LOAD_ACQUIRE(&exp->port);
+}
@@ -0,0 +1,103 @@
+#include "buttonlib_i2c_dma.h"
+#include "hardware/dma.h"
+
+/** Finish the running transfer and hand the bus back to the expander layer. */
+static void finish(btn_i2c_dma_t *drv, bool ok) {
+    btn_xfer_done_fn_t done     = drv->done;
+    void              *done_arg = drv->done_arg;
+
+    drv->done = NULL;
+    if (done) {
+        done(done_arg, ok);
+    }
+}
+
+bool btn_i2c_dma_init(btn_i2c_dma_t *drv, i2c_inst_t *i2c) {
+    if (!drv || !i2c) return false;
+
+    int tx = dma_claim_unused_channel(false);
+    if (tx < 0) return false;
+    int rx = dma_claim_unused_channel(false);
+    if (rx < 0) {
+        dma_channel_unclaim((uint)tx);
+        return false;
+    }
+
+    drv->i2c     = i2c;
+    drv->tx_chan = (uint)tx;
+    drv->rx_chan = (uint)rx;
+    drv->done    = NULL;
+
+    dma_channel_set_irq0_enabled(drv->rx_chan, true);
+    i2c_get_hw(i2c)->intr_mask = I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+
+    return true;
+}
+
+bool btn_i2c_dma_start(void *bus_arg,
+                       uint8_t addr,
+                       const uint8_t *tx, size_t tx_len,
+                       uint8_t *rx, size_t rx_len,
+                       btn_xfer_done_fn_t done,
+                       void *done_arg) {
+    btn_i2c_dma_t *drv = (btn_i2c_dma_t*)bus_arg;
+    if (!drv || drv->done || rx_len == 0) return false;
+    if (tx_len + rx_len > BTN_I2C_DMA_MAX_CMDS) return false;
+
+    i2c_hw_t *hw = i2c_get_hw(drv->i2c);
+
+    // Register address writes, then reads; RESTART before the first read
+    // (after a write), STOP after the last one.
+    size_t n = 0;
+    for (size_t i = 0; i < tx_len; i++) {
+        drv->cmds[n++] = tx[i];
+    }
+    for (size_t i = 0; i < rx_len; i++) {
+        uint32_t cmd = I2C_IC_DATA_CMD_CMD_BITS;
+        if (i == 0 && tx_len)     cmd |= I2C_IC_DATA_CMD_RESTART_BITS;
+        if (i == rx_len - 1)      cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+        drv->cmds[n++] = cmd;
+    }
+
+    drv->done     = done;
+    drv->done_arg = done_arg;
+
+    hw->enable = 0;
+    hw->tar    = addr;
+    hw->enable = 1;
+
+    dma_channel_config rc = dma_channel_get_default_config(drv->rx_chan);
+    channel_config_set_transfer_data_size(&rc, DMA_SIZE_8);
+    channel_config_set_read_increment(&rc, false);
+    channel_config_set_write_increment(&rc, true);
+    channel_config_set_dreq(&rc, i2c_get_dreq(drv->i2c, false));
+    dma_channel_configure(drv->rx_chan, &rc, rx, &hw->data_cmd, rx_len, true);
+
+    dma_channel_config tc = dma_channel_get_default_config(drv->tx_chan);
+    channel_config_set_transfer_data_size(&tc, DMA_SIZE_32);
+    channel_config_set_read_increment(&tc, true);
+    channel_config_set_write_increment(&tc, false);
+    channel_config_set_dreq(&tc, i2c_get_dreq(drv->i2c, true));
+    dma_channel_configure(drv->tx_chan, &tc, &hw->data_cmd, drv->cmds, n, true);
+
+    return true;
+}
+
+void btn_i2c_dma_irq(btn_i2c_dma_t *drv) {
+    i2c_hw_t *hw = i2c_get_hw(drv->i2c);
+
+    // NACK / arbitration loss: the reads never arrive, stop the channels.
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        dma_channel_abort(drv->tx_chan);
+        dma_channel_abort(drv->rx_chan);
+        dma_channel_acknowledge_irq0(drv->rx_chan);
+        (void)hw->clr_tx_abrt;
+        finish(drv, false);
+        return;
+    }
+
+    if (dma_channel_get_irq0_status(drv->rx_chan)) {
+        dma_channel_acknowledge_irq0(drv->rx_chan);
+        finish(drv, true);
+    }
+}
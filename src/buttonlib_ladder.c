@@ -0,0 +1,88 @@
+#include "buttonlib_ladder.h"
+
+#define FEED_CHUNK 32u  // Decoded samples per btn_feed_bank_samples() call
+
+bool btn_ladder_init(btn_ladder_t *ld,
+                     const btn_ladder_level_t *levels,
+                     size_t count,
+                     uint16_t tolerance,
+                     btn_adc_read_fn_t read_fn,
+                     void *arg) {
+    if (!ld || !levels || count == 0) return false;
+
+    for (size_t i = 1; i < count; i++) {
+        if (levels[i].raw <= levels[i - 1].raw) return false;
+    }
+
+    ld->read_fn   = read_fn;
+    ld->arg       = arg;
+    ld->levels    = levels;
+    ld->count     = count;
+    ld->tolerance = tolerance;
+    ld->mask      = 0;
+    ld->last_raw  = 0;
+    ld->samples   = 0;
+    ld->rejected  = 0;
+
+    return true;
+}
+
+uint32_t btn_ladder_decode(btn_ladder_t *ld, uint16_t raw) {
+    const btn_ladder_level_t *lv = ld->levels;
+
+    // Nearest level: first one whose upper midpoint is not below raw.
+    size_t lo = 0, hi = ld->count - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        uint32_t threshold = ((uint32_t)lv[mid].raw + lv[mid + 1].raw) / 2u;
+        if (raw > threshold) lo = mid + 1;
+        else                 hi = mid;
+    }
+
+    ld->last_raw = raw;
+    ld->samples++;
+
+    uint16_t dist = raw > lv[lo].raw ? (uint16_t)(raw - lv[lo].raw)
+                                     : (uint16_t)(lv[lo].raw - raw);
+    if (ld->tolerance && dist > ld->tolerance) {
+        ld->rejected++;     // Settling between two states
+        return ld->mask;
+    }
+
+    ld->mask = lv[lo].mask;
+    return ld->mask;
+}
+
+uint32_t btn_ladder_read(void *arg) {
+    btn_ladder_t *ld = (btn_ladder_t*)arg;
+    if (!ld->read_fn) return ld->mask;
+
+    return btn_ladder_decode(ld, ld->read_fn(ld->arg));
+}
+
+size_t btn_ladder_feed_samples(btn_ladder_t *ld,
+                               btn_context_t *ctx,
+                               uint8_t bank,
+                               const uint16_t *raw,
+                               size_t count,
+                               uint64_t t0_us,
+                               uint32_t period_ns) {
+    if (!ld || !raw) return 0;
+
+    uint32_t masks[FEED_CHUNK];
+    size_t   scanned = 0;
+
+    for (size_t done = 0; done < count; ) {
+        size_t n = count - done < FEED_CHUNK ? count - done : FEED_CHUNK;
+
+        for (size_t i = 0; i < n; i++) {
+            masks[i] = btn_ladder_decode(ld, raw[done + i]);
+        }
+
+        uint64_t t = t0_us + (uint64_t)done * period_ns / 1000u;
+        scanned += btn_feed_bank_samples(ctx, bank, masks, n, t, period_ns);
+        done    += n;
+    }
+
+    return scanned;
+}
@@ -0,0 +1,96 @@
+#include "buttonlib_pio.h"
+#include "pico/time.h"
+
+#include "buttonlib_sample.pio.h"
+
+// Ring indices are shared between the capturing IRQ and the main loop.
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/**
+ * Copy of the sampler program with every `in pins, 32` narrowed to count
+ * bits: the ISR starts from null, so samples hold only the bank pins.
+ */
+static pio_program_t sample_program(uint16_t *insn, uint count) {
+    pio_program_t prog = buttonlib_sample_program;
+    uint16_t      wide = pio_encode_in(pio_pins, 32);
+
+    for (uint i = 0; i < prog.length; i++) {
+        uint16_t op = buttonlib_sample_program_instructions[i];
+        insn[i] = op == wide ? pio_encode_in(pio_pins, count) : op;
+    }
+
+    prog.instructions = insn;
+    return prog;
+}
+
+bool btn_pio_init(btn_pio_t *drv,
+                  PIO pio,
+                  uint pin_base,
+                  uint pin_count,
+                  float sample_hz,
+                  uint8_t bank) {
+    if (!drv || pin_count == 0 || pin_count > 32 || sample_hz <= 0.0f) return false;
+
+    // The divider is a 16.8 fixed-point value; out of range it would wrap.
+    float div = buttonlib_sample_clkdiv(sample_hz);
+    if (div < 1.0f || div > 65536.0f) return false;
+
+    uint16_t      insn[count_of(buttonlib_sample_program_instructions)];
+    pio_program_t prog = sample_program(insn, pin_count);
+    if (!pio_can_add_program(pio, &prog)) return false;
+
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) return false;
+
+    drv->pio      = pio;
+    drv->sm       = (uint)sm;
+    drv->offset   = pio_add_program(pio, &prog);
+    drv->pin_base = pin_base;
+    drv->pin_mask = pin_count == 32 ? 0xFFFFFFFFu : (1u << pin_count) - 1u;
+    drv->bank     = bank;
+    drv->head     = 0;
+    drv->tail     = 0;
+    drv->overruns = 0;
+
+    buttonlib_sample_program_init(pio, drv->sm, drv->offset, pin_base, sample_hz);
+
+    return true;
+}
+
+void btn_pio_capture(btn_pio_t *drv) {
+    size_t head = drv->head;
+
+    while (!pio_sm_is_rx_fifo_empty(drv->pio, drv->sm)) {
+        size_t next = (head + 1) % BTN_PIO_RING_SIZE;
+        if (next == LOAD_ACQUIRE(&drv->tail)) {
+            // Keep the rest in the FIFO (the state machine stalls, nothing is lost).
+            drv->overruns++;
+            break;
+        }
+
+        drv->ring[head].levels = pio_sm_get(drv->pio, drv->sm) & drv->pin_mask;
+        drv->ring[head].t_us   = time_us_64();
+        head = next;
+    }
+
+    STORE_RELEASE(&drv->head, head);
+}
+
+size_t btn_pio_service(btn_pio_t *drv, btn_context_t *ctx) {
+    if (!drv || !ctx) return 0;
+
+    size_t tail = drv->tail;
+    size_t head = LOAD_ACQUIRE(&drv->head);
+    size_t fed  = 0;
+
+    while (tail != head) {
+        btn_feed_bank(ctx, drv->bank, drv->ring[tail].levels, drv->ring[tail].t_us);
+        tail = (tail + 1) % BTN_PIO_RING_SIZE;
+        fed++;
+    }
+
+    STORE_RELEASE(&drv->tail, tail);
+
+    return fed;
+}
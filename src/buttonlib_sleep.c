@@ -0,0 +1,187 @@
+#include "buttonlib_sleep.h"
+#include <string.h>
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pll.h"
+#include "hardware/sync.h"
+#include "hardware/xosc.h"
+#include "hardware/structs/clocks.h"
+#include "hardware/structs/rosc.h"
+#include "hardware/structs/scb.h"
+#include "pico/runtime_init.h"
+#include "pico/time.h"
+
+#define EDGE_EVENTS  (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+#define LEVEL_EVENTS (GPIO_IRQ_LEVEL_LOW | GPIO_IRQ_LEVEL_HIGH)
+
+// Shared raw GPIO handlers take no argument.
+static btn_sleep_t *active_sleep;
+
+static void notify_all(btn_sleep_t *sl, uint64_t now_us) {
+    for (uint32_t m = sl->pin_mask; m; m &= m - 1) {
+        uint8_t id = sl->pin_ids[__builtin_ctz(m)];
+        int     i  = btn_find_index(sl->ctx, id);
+
+        // Banks are read on every btn_update(); only read_fn buttons wait
+        // for an edge. A made-up edge would restart their debounce.
+        if (i < 0 || sl->ctx->buttons[i].config->source == BTN_SRC_BANK) continue;
+
+        btn_notify_edge(sl->ctx, id, now_us);
+    }
+    sl->woken = true;
+}
+
+static void gpio_irq_handler(void) {
+    btn_sleep_t *sl = active_sleep;
+    if (!sl) return;
+
+    uint64_t now_us = time_us_64();
+
+    for (uint32_t m = sl->pin_mask; m; m &= m - 1) {
+        uint gpio = (uint)__builtin_ctz(m);
+        uint32_t events = gpio_get_irq_event_mask(gpio) & EDGE_EVENTS;
+        if (!events) continue;
+
+        gpio_acknowledge_irq(gpio, events);
+        btn_notify_edge(sl->ctx, sl->pin_ids[gpio], now_us);
+        sl->woken = true;
+    }
+
+    // An edge just before __wfe() must not be slept through.
+    __sev();
+}
+
+/** True if an edge is latched but not yet handled (IRQs disabled). */
+static bool edge_latched(const btn_sleep_t *sl) {
+    for (uint32_t m = sl->pin_mask; m; m &= m - 1) {
+        if (gpio_get_irq_event_mask((uint)__builtin_ctz(m)) & EDGE_EVENTS) return true;
+    }
+    return false;
+}
+
+/** WFE until the deadline (BTN_NO_DEADLINE: until an IRQ), optionally with SLEEPDEEP. */
+static void sleep_until(btn_sleep_t *sl, uint64_t deadline) {
+    uint32_t en0 = clocks_hw->sleep_en0;
+    uint32_t en1 = clocks_hw->sleep_en1;
+
+    if (sl->deep_sleep) {
+        // Only what the wake sources need: GPIO edges and the timer alarm.
+        clocks_hw->sleep_en0 = CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS
+                             | CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS;
+        clocks_hw->sleep_en1 = CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS
+                             | CLOCKS_SLEEP_EN1_CLK_SYS_WATCHDOG_BITS;
+        scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+    }
+
+    if (deadline == BTN_NO_DEADLINE) {
+        __wfe();
+    } else {
+        best_effort_wfe_or_timeout(from_us_since_boot(deadline));
+    }
+
+    if (sl->deep_sleep) {
+        scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+        clocks_hw->sleep_en0 = en0;
+        clocks_hw->sleep_en1 = en1;
+    }
+
+    sl->sleeps++;
+}
+
+/** Stop the crystal until a wake pin changes level, then restore the clocks. */
+static void enter_dormant(btn_sleep_t *sl) {
+    uint32_t irq_state = save_and_disable_interrupts();
+
+    // Level wake on the opposite of the current level: a change that races
+    // with arming wakes the chip right away instead of being missed.
+    for (uint32_t m = sl->pin_mask; m; m &= m - 1) {
+        uint gpio = (uint)__builtin_ctz(m);
+        gpio_set_dormant_irq_enabled(gpio, gpio_get(gpio) ? GPIO_IRQ_LEVEL_LOW
+                                                          : GPIO_IRQ_LEVEL_HIGH, true);
+    }
+
+    if (!sl->woken && !edge_latched(sl)) {
+        // Everything from the crystal, then PLLs and ROSC off.
+        clock_configure(clk_ref, CLOCKS_CLK_REF_CTRL_SRC_VALUE_XOSC_CLKSRC, 0, XOSC_HZ, XOSC_HZ);
+        clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF, 0, XOSC_HZ, XOSC_HZ);
+        clock_stop(clk_usb);
+        clock_stop(clk_adc);
+#if PICO_RP2040
+        clock_stop(clk_rtc);
+#endif
+        clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS, XOSC_HZ, XOSC_HZ);
+        pll_deinit(pll_sys);
+        pll_deinit(pll_usb);
+        hw_write_masked(&rosc_hw->ctrl, ROSC_CTRL_ENABLE_VALUE_DISABLE << ROSC_CTRL_ENABLE_LSB,
+                        ROSC_CTRL_ENABLE_BITS);
+
+        xosc_dormant();     // Returns once a wake pin changed level
+
+        hw_write_masked(&rosc_hw->ctrl, ROSC_CTRL_ENABLE_VALUE_ENABLE << ROSC_CTRL_ENABLE_LSB,
+                        ROSC_CTRL_ENABLE_BITS);
+        runtime_init_clocks();
+        sl->dormant_entries++;
+    }
+
+    for (uint32_t m = sl->pin_mask; m; m &= m - 1) {
+        gpio_set_dormant_irq_enabled((uint)__builtin_ctz(m), LEVEL_EVENTS, false);
+    }
+
+    // The edge IRQ logic was stopped with clk_sys: resample every pin.
+    notify_all(sl, time_us_64());
+
+    restore_interrupts(irq_state);
+}
+
+bool btn_sleep_init(btn_sleep_t *sl,
+                    btn_context_t *ctx,
+                    const btn_sleep_pin_t *pins,
+                    size_t count) {
+    if (!sl || !ctx || !pins || count == 0) return false;
+
+    for (size_t i = 0; i < count; i++) {
+        if (pins[i].gpio >= NUM_BANK0_GPIOS) return false;
+    }
+
+    memset(sl, 0, sizeof(btn_sleep_t));
+    sl->ctx = ctx;
+
+    for (size_t i = 0; i < count; i++) {
+        sl->pin_mask |= 1u << pins[i].gpio;
+        sl->pin_ids[pins[i].gpio] = pins[i].btn_id;
+    }
+
+    btn_set_edge_mode(ctx, true);
+
+    active_sleep = sl;
+    gpio_add_raw_irq_handler_masked(sl->pin_mask, gpio_irq_handler);
+    for (uint32_t m = sl->pin_mask; m; m &= m - 1) {
+        gpio_set_irq_enabled((uint)__builtin_ctz(m), EDGE_EVENTS, true);
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    return true;
+}
+
+uint64_t btn_sleep_wait(btn_sleep_t *sl) {
+    if (!sl) return time_us_64();
+
+    for (;;) {
+        uint64_t now_us = time_us_64();
+
+        if (sl->woken) {
+            sl->woken = false;
+            return now_us;
+        }
+
+        uint64_t deadline = btn_next_deadline(sl->ctx);
+        if (deadline <= now_us) return now_us;
+
+        if (deadline == BTN_NO_DEADLINE && sl->dormant) {
+            enter_dormant(sl);
+        } else {
+            sleep_until(sl, deadline);
+        }
+    }
+}
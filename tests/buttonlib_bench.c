@@ -0,0 +1,330 @@
+#ifndef BUTTONLIB_BENCH_SYSTICK
+#define _POSIX_C_SOURCE 199309L     // clock_gettime()
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "buttonlib.h"
+
+/*
+ * Benchmark of btn_update() and the event queue.
+ *
+ * Synthetic virtual buttons (one bit each in bench_levels[]) are driven
+ * through idle / bursty / chatter workloads at a simulated 1 kHz update
+ * rate, read either through per-button read_fn callbacks or through banks.
+ *
+ * Host build: wall-clock nanoseconds (clock_gettime).
+ * On target (BUTTONLIB_BENCH_SYSTICK): CPU cycles from SysTick.
+ */
+
+#ifdef BUTTONLIB_BENCH_SYSTICK
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#else
+#include <time.h>
+#endif
+
+#ifndef BENCH_TICKS
+#define BENCH_TICKS 20000u      // Simulated 1 ms updates per run
+#endif
+
+#define BENCH_MAX_BUTTONS 256u
+#define BENCH_MAX_BANKS   (BENCH_MAX_BUTTONS / 32u)
+#define BENCH_QUEUE_SIZE  256u
+#define BENCH_DRAIN_MAX   64u
+#define BENCH_TICK_US     1000u
+
+/* -------------------------------------------------------------------------- */
+/*  Clock                                                                     */
+/* -------------------------------------------------------------------------- */
+
+#ifdef BUTTONLIB_BENCH_SYSTICK
+
+#define BENCH_UNIT "cyc"
+
+typedef uint32_t bench_clock_t;
+
+static void clock_setup(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0x00FFFFFFu;          // Full 24-bit range
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;                  // Enable, processor clock, no IRQ
+}
+
+static inline bench_clock_t clock_now(void) {
+    return systick_hw->cvr;
+}
+
+/** SysTick counts down and wraps at 24 bits. */
+static inline uint32_t clock_delta(bench_clock_t start, bench_clock_t end) {
+    return (start - end) & 0x00FFFFFFu;
+}
+
+static double units_to_ns(double units) {
+    return units * 1e9 / (double)clock_get_hz(clk_sys);
+}
+
+#else
+
+#define BENCH_UNIT "ns"
+
+typedef uint64_t bench_clock_t;
+
+static void clock_setup(void) {
+}
+
+static inline bench_clock_t clock_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint32_t clock_delta(bench_clock_t start, bench_clock_t end) {
+    return (uint32_t)(end - start);
+}
+
+static double units_to_ns(double units) {
+    return units;
+}
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*  Virtual buttons                                                           */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t bench_levels[BENCH_MAX_BANKS];  // Bit n = button n electrically active
+
+static bool vbtn_read_fn(void *arg) {
+    uint32_t n = (uint32_t)(uintptr_t)arg;
+    return (bench_levels[n >> 5] >> (n & 31u)) & 1u;
+}
+
+static uint32_t vbank_read_fn(void *arg) {
+    return *(const uint32_t *)arg;
+}
+
+static inline void set_level(uint32_t n, bool level) {
+    if (level) bench_levels[n >> 5] |=  (1u << (n & 31u));
+    else       bench_levels[n >> 5] &= ~(1u << (n & 31u));
+}
+
+/** xorshift32: deterministic, identical on host and target. */
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Workloads                                                                 */
+/* -------------------------------------------------------------------------- */
+
+typedef enum {
+    WL_IDLE,        ///< Nothing pressed: pure scan cost
+    WL_BURSTY,      ///< Every 50 ms 1/8 of the buttons get a 30..330 ms press
+    WL_CHATTER,     ///< Every button cycles press/release with 8 ms contact bounce
+} workload_t;
+
+static const char *const workload_names[] = { "idle", "bursty", "chatter" };
+
+static uint16_t release_tick[BENCH_MAX_BUTTONS];   // WL_BURSTY: tick of the release
+static uint8_t  phase[BENCH_MAX_BUTTONS];          // WL_CHATTER: per-button offset
+
+static void workload_reset(uint32_t count) {
+    rng_state = 0x2545F491u;
+    memset(bench_levels, 0, sizeof(bench_levels));
+    memset(release_tick, 0, sizeof(release_tick));
+
+    for (uint32_t n = 0; n < count; n++) {
+        phase[n] = (uint8_t)(rng() % 40u);
+    }
+}
+
+static void workload_step(workload_t wl, uint32_t count, uint32_t tick) {
+    switch (wl) {
+    case WL_IDLE:
+        break;
+
+    case WL_BURSTY:
+        for (uint32_t n = 0; n < count; n++) {
+            if (release_tick[n] == tick) set_level(n, false);
+        }
+        if (tick % 50u == 0) {
+            uint32_t presses = count / 8u ? count / 8u : 1u;
+            for (uint32_t k = 0; k < presses; k++) {
+                uint32_t n = rng() % count;
+                set_level(n, true);
+                release_tick[n] = (uint16_t)(tick + 30u + rng() % 300u);
+            }
+        }
+        break;
+
+    case WL_CHATTER:
+        // 40 ms cycle: 8 ms bounce, 12 ms pressed, 8 ms bounce, 12 ms released
+        for (uint32_t n = 0; n < count; n++) {
+            uint32_t t = (tick + phase[n]) % 40u;
+            bool level;
+            if (t < 8u || (t >= 20u && t < 28u)) {
+                level = rng() & 1u;
+            } else {
+                level = (t < 20u);
+            }
+            set_level(n, level);
+        }
+        break;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Runner                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static btn_config_t   cfgs[BENCH_MAX_BUTTONS];
+static btn_state_t    states[BENCH_MAX_BUTTONS];
+static btn_instance_t buttons[BENCH_MAX_BUTTONS];
+static btn_bank_t     banks[BENCH_MAX_BANKS];
+static btn_event_t    queue[BENCH_QUEUE_SIZE];
+static btn_event_t    drain[BENCH_DRAIN_MAX];
+static btn_context_t  ctx;
+
+typedef struct {
+    uint64_t update_units;  ///< Sum of btn_update() times
+    uint32_t update_max;    ///< Worst btn_update()
+    uint64_t pop_units;     ///< Sum of non-empty btn_pop_events() times
+    uint32_t pops;          ///< Number of non-empty btn_pop_events() calls
+    uint32_t events;
+    size_t   dropped;
+} bench_result_t;
+
+static void setup_context(uint32_t count, bool use_banks) {
+    btn_init(&ctx, buttons, count, queue, BENCH_QUEUE_SIZE);
+
+    if (use_banks) {
+        uint32_t bank_count = (count + 31u) / 32u;
+        btn_init_banks(&ctx, banks, bank_count);
+        for (uint32_t b = 0; b < bank_count; b++) {
+            btn_setup_bank(&ctx, (uint8_t)b, vbank_read_fn, &bench_levels[b]);
+        }
+    }
+
+    for (uint32_t n = 0; n < count; n++) {
+        cfgs[n] = (btn_config_t){
+            .id               = (uint8_t)n,
+            .active_low       = false,
+            .read_fn          = use_banks ? NULL : vbtn_read_fn,
+            .hw_arg           = (void *)(uintptr_t)n,
+            .debounce_ms      = 5,
+            .click_timeout_ms = 150,
+            .long_press_ms    = 400,
+            .repeat_period_ms = 100,
+            .source           = use_banks ? BTN_SRC_BANK : BTN_SRC_READ_FN,
+            .bank             = (uint8_t)(n / 32u),
+            .bank_bit         = (uint8_t)(n % 32u),
+        };
+        btn_setup(&ctx, (uint8_t)n, &cfgs[n], &states[n]);
+    }
+}
+
+static bench_result_t run(uint32_t count, bool use_banks, workload_t wl) {
+    bench_result_t r = { 0 };
+
+    setup_context(count, use_banks);
+    workload_reset(count);
+
+    uint64_t now = 0;
+    for (uint32_t tick = 0; tick < BENCH_TICKS; tick++) {
+        workload_step(wl, count, tick);
+        now += BENCH_TICK_US;
+
+        bench_clock_t t0 = clock_now();
+        btn_update(&ctx, now);
+        uint32_t u = clock_delta(t0, clock_now());
+        r.update_units += u;
+        if (u > r.update_max) r.update_max = u;
+
+        bench_clock_t t1 = clock_now();
+        size_t n = btn_pop_events(&ctx, drain, BENCH_DRAIN_MAX);
+        uint32_t p = clock_delta(t1, clock_now());
+
+        // Queue throughput counts only drains that returned events.
+        if (n > 0) {
+            r.pop_units += p;
+            r.pops++;
+        }
+        r.events += (uint32_t)n;
+    }
+
+    r.dropped = btn_get_dropped_events(&ctx);
+    return r;
+}
+
+/** Cost of one clock_now() pair, subtracted from every measurement. */
+static uint32_t clock_overhead(void) {
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < 1000; i++) {
+        bench_clock_t t0 = clock_now();
+        uint32_t d = clock_delta(t0, clock_now());
+        if (d < best) best = d;
+    }
+    return best;
+}
+
+int main(void) {
+#ifdef BUTTONLIB_BENCH_SYSTICK
+    stdio_init_all();
+    sleep_ms(2000);     // Give USB CDC time to enumerate
+#endif
+    clock_setup();
+
+    static const uint32_t sizes[] = { 1, 8, 32, 64, 256 };
+    uint32_t overhead = clock_overhead();
+
+    printf("buttonlib bench: %u ticks of %u us, state %u bytes, event %u bytes, clock overhead %u %s\n",
+           (unsigned)BENCH_TICKS, (unsigned)BENCH_TICK_US,
+           (unsigned)sizeof(btn_state_t), (unsigned)sizeof(btn_event_t),
+           (unsigned)overhead, BENCH_UNIT);
+    printf("%-6s %-8s %7s %12s %12s %10s %12s %12s %8s\n",
+           "source", "workload", "buttons",
+           BENCH_UNIT "/tick", "max " BENCH_UNIT, "events",
+           "Mevt/s", BENCH_UNIT "/pop", "dropped");
+
+    for (int src = 0; src < 2; src++) {
+        for (int wl = WL_IDLE; wl <= WL_CHATTER; wl++) {
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+                bench_result_t r = run(sizes[s], src == 1, (workload_t)wl);
+
+                uint64_t upd = r.update_units > (uint64_t)overhead * BENCH_TICKS
+                             ? r.update_units - (uint64_t)overhead * BENCH_TICKS : 0;
+                uint64_t pop = r.pop_units > (uint64_t)overhead * r.pops
+                             ? r.pop_units - (uint64_t)overhead * r.pops : 0;
+
+                double per_tick = (double)upd / BENCH_TICKS;
+                double upd_ns   = units_to_ns((double)upd);
+                double mevt_s   = upd_ns > 0 ? r.events * 1e3 / upd_ns : 0.0;
+                double per_pop  = r.events ? (double)pop / r.events : 0.0;
+
+                printf("%-6s %-8s %7u %12.1f %12u %10u %12.2f %12.1f %8u\n",
+                       src ? "bank" : "read",
+                       workload_names[wl],
+                       (unsigned)sizes[s],
+                       per_tick,
+                       (unsigned)(r.update_max > overhead ? r.update_max - overhead : 0),
+                       (unsigned)r.events,
+                       mevt_s,
+                       per_pop,
+                       (unsigned)r.dropped);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * C++17 front-end checks: the header-only wrappers are instantiated and
+ * driven through one press, so template code is compiled and run on the
+ * host like the C core. Exits non-zero if a check fails.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <array>
+
+#include "buttonlib.h"
+#include "buttonlib.hpp"
+#include "buttonlib_table.hpp"
+
+static int check_failures;
+
+/** Assert inside a test; main() exits non-zero if any check failed. */
+#define CHECK(cond)                                                       \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            check_failures++;                                             \
+            std::printf("CHECK FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                 \
+    } while (0)
+
+static void print_event(const char *label, const btn_event_t &evt) {
+    std::printf("%s: id=%u type=%d clicks=%u ts=%llu\n",
+                label,
+                evt.btn_id,
+                static_cast<int>(evt.type),
+                evt.clicks,
+                static_cast<unsigned long long>(evt.timestamp));
+}
+
+/* -------------------------------------------------------------------------- */
+/*  btn::Table: constexpr table wired with btn_setup_table()                  */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t table_levels = 0xFFFFFFFFu;   // Two active-low bank pins, idle high
+static bool     table_read   = false;
+
+static uint32_t table_bank_read(void *) { return table_levels; }
+static bool     table_btn_read(void *)  { return table_read; }
+
+static constexpr btn::Timings kTimings{10, 200, 800, 0};
+static constexpr std::array<btn_config_t, 3> kTable{{
+    btn::bank_button(10, 0, 4, true, kTimings),
+    btn::bank_button(20, 0, 5, true, kTimings),
+    btn::read_button(30, table_btn_read, nullptr, false, kTimings),
+}};
+static btn::Table<kTable> table;
+
+static_assert(btn::Table<kTable>::bank_mask(0) == 0x30u, "bank mask of the table");
+static_assert(btn::Table<kTable>::index_of(30) == 2, "index of a read_fn entry");
+
+static void test_table() {
+    std::printf("=== TEST: btn::Table ===\n");
+
+    btn_context_t ctx;
+    btn_bank_t    banks[1];
+    btn_event_t   queue[16];
+
+    btn_init(&ctx, table.buttons(), table.size, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup_bank(&ctx, 0, table_bank_read, nullptr);
+    bool ok = table.setup(&ctx);
+
+    std::printf("Table: ok=%d used=%08lx invert=%08lx\n", ok,
+                static_cast<unsigned long>(banks[0].used_mask),
+                static_cast<unsigned long>(banks[0].invert_mask));
+    CHECK(ok);
+    CHECK(banks[0].used_mask == btn::Table<kTable>::bank_mask(0));
+    CHECK(banks[0].invert_mask == btn::Table<kTable>::invert_mask(0));
+
+    // Press and release button 20 (bank bit 5, active low).
+    uint64_t now = 0;
+    btn_update(&ctx, now);
+    table_levels &= ~(1u << 5);
+    for (int i = 0; i < 3; i++) {
+        now += 10000;
+        btn_update(&ctx, now);
+    }
+    table_levels |= 1u << 5;
+    for (int i = 0; i < 30; i++) {
+        now += 10000;
+        btn_update(&ctx, now);
+    }
+
+    int downs = 0, clicks = 0;
+    btn_event_t evt;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", evt);
+        CHECK(evt.btn_id == 20);
+        downs  += evt.type == BTN_EVT_DOWN;
+        clicks += evt.type == BTN_EVT_CLICK;
+    }
+    CHECK(downs == 1 && clicks == 1);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  btn::ButtonBank: inline storage, compile-time read and queue policies     */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t bank_pins = 0x7u;   // Three active-low pins, idle high
+
+static uint32_t read_bank_pins() { return bank_pins; }
+
+static constexpr std::array<btn_config_t, 3> kBank{{
+    btn::bank_button(1, 0, 0, true, kTimings),
+    btn::bank_button(2, 0, 1, true, kTimings),
+    btn::bank_button(3, 0, 2, true, kTimings),
+}};
+
+static btn::ButtonBank<3, btn::FnRead<read_bank_pins>, btn::SpscQueue<16>> ui;
+
+static void test_button_bank() {
+    std::printf("=== TEST: btn::ButtonBank ===\n");
+
+    bool ok = ui.begin(kBank);
+    std::printf("ButtonBank: ok=%d size=%u\n", ok, static_cast<unsigned>(ui.size));
+    CHECK(ok);
+
+    // Press and release button 3 (bit 2).
+    uint64_t now = 0;
+    ui.update(now);
+    bank_pins &= ~(1u << 2);
+    for (int i = 0; i < 3; i++) {
+        now += 10000;
+        ui.update(now);
+    }
+    CHECK(ui.pressed(2));
+    CHECK(!ui.pressed(0) && !ui.pressed(1));
+
+    bank_pins |= 1u << 2;
+    for (int i = 0; i < 30; i++) {
+        now += 10000;
+        ui.update(now);
+    }
+    CHECK(!ui.pressed(2));
+
+    int downs = 0, clicks = 0;
+    btn_event_t evt;
+    while (ui.pop(evt)) {
+        print_event("EVT", evt);
+        CHECK(evt.btn_id == 3);
+        downs  += evt.type == BTN_EVT_DOWN;
+        clicks += evt.type == BTN_EVT_CLICK;
+    }
+    CHECK(downs == 1 && clicks == 1);
+    CHECK(ui.dropped_events() == 0);
+}
+
+int main() {
+    test_table();
+    test_button_bank();
+
+    if (check_failures) {
+        std::printf("%d check(s) failed\n", check_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,448 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "buttonlib.h"
+
+/*
+ * Virtual-time simulation of the button state machine.
+ *
+ * Every script draws random timings and random press / chatter / hold
+ * waveforms for several virtual buttons. Durations are biased towards the
+ * timing thresholds (threshold - 1, threshold, threshold + 1, ...) so every
+ * strict / non-strict boundary is hit. The library is driven in virtual
+ * time: btn_update() runs only at raw edges and at btn_next_deadline(), so
+ * hours of input cost a few hundred updates.
+ *
+ * The resulting event stream is compared with an independent reference
+ * model that derives the expected events directly from the waveforms.
+ *
+ * Usage: buttonlib_sim [scripts] [seed]
+ */
+
+#define SIM_MAX_BUTTONS 8
+#define SIM_MAX_EDGES   96
+#define SIM_MAX_EVENTS  512
+#define SIM_NEVER       UINT64_MAX
+
+// Start close to 2^32 us so 32-bit (compact) times wrap inside most scripts.
+#define SIM_START_US    ((1ULL << 32) - 3000000ULL)
+
+typedef struct {
+    uint64_t emit_us;   ///< Time of the btn_update() that emits the event
+    uint8_t  index;     ///< Button index (update order within one call)
+    btn_event_t evt;
+} sim_event_t;
+
+/** Thresholds in us, derived from the btn_config_t ms values. */
+typedef struct {
+    uint64_t debounce_us;
+    uint64_t click_timeout_us;
+    uint64_t long_press_us;
+    uint64_t repeat_period_us;
+} sim_thresholds_t;
+
+typedef struct {
+    uint64_t times[SIM_MAX_EDGES];  ///< Raw edge times; edge k sets level (k odd ? 0 : 1)
+    size_t   count;
+    size_t   next;                  ///< Next edge to apply
+    bool     level;
+} sim_wave_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Random scripts                                                            */
+/* -------------------------------------------------------------------------- */
+
+static uint64_t rng_state;
+
+static uint32_t rng(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi) {
+    return lo + rng() % (hi - lo + 1);
+}
+
+// Straight from the config, never from btn_state_t: a threshold caching
+// bug in the library must not be mirrored by the model.
+static sim_thresholds_t thresholds_of(const btn_config_t *cfg) {
+    return (sim_thresholds_t){
+        .debounce_us      = cfg->debounce_ms * 1000ULL,
+        .click_timeout_us = cfg->click_timeout_ms * 1000ULL,
+        .long_press_us    = cfg->long_press_ms * 1000ULL,
+        .repeat_period_us = cfg->repeat_period_ms * 1000ULL,
+    };
+}
+
+/** A duration in us close to one of the thresholds, or a random one. */
+static uint64_t pick_duration(const uint64_t *thresholds, size_t count, uint64_t max_random) {
+    if (rng() % 4 == 0) {
+        return 1 + rng() % max_random;
+    }
+
+    uint64_t base  = thresholds[rng() % count];
+    int32_t  delta = (int32_t)rng_range(0, 6) - 3;     // -3 .. +3 us
+    if (rng() % 8 == 0) delta = (int32_t)rng_range(0, 2000) - 1000;
+
+    int64_t d = (int64_t)base + delta;
+    return d < 1 ? 1 : (uint64_t)d;
+}
+
+static void add_edge(sim_wave_t *w, uint64_t *t, uint64_t gap) {
+    if (w->count >= SIM_MAX_EDGES) return;
+    *t += gap;
+    w->times[w->count++] = *t;
+}
+
+/**
+ * One button waveform: presses separated by gaps, optionally with contact
+ * bounce on both transitions. Always ends released.
+ */
+static void make_wave(sim_wave_t *w, const sim_thresholds_t *th, uint64_t start) {
+    const uint64_t d = th->debounce_us;
+    const uint64_t hold_th[] = {
+        d + 1, d + 2,
+#if BUTTONLIB_ENABLE_LONGPRESS
+        th->long_press_us, th->long_press_us + 1, th->long_press_us + 2,
+#endif
+#if BUTTONLIB_ENABLE_REPEAT
+        th->long_press_us + 1 + (th->repeat_period_us + 1) * 2,
+#endif
+    };
+    const uint64_t gap_th[] = {
+        d + 1, d + 2,
+#if BUTTONLIB_ENABLE_MULTICLICK
+        th->click_timeout_us, th->click_timeout_us + 1, th->click_timeout_us + 2,
+#endif
+    };
+
+    memset(w, 0, sizeof(*w));
+    uint64_t t = start + rng() % 5000;
+
+    int presses = (int)rng_range(1, 6);
+    for (int p = 0; p < presses && w->count + 24 < SIM_MAX_EDGES; p++) {
+        uint64_t gap = pick_duration(gap_th, sizeof(gap_th) / sizeof(gap_th[0]), 400000);
+        add_edge(w, &t, gap);                                           // Press
+
+        if (rng() % 3 == 0) {
+            // Bounce: short pulses, some shorter and some longer than debounce
+            int bounces = (int)rng_range(1, 4);
+            for (int b = 0; b < bounces; b++) {
+                add_edge(w, &t, 1 + rng() % (d + 2));
+                add_edge(w, &t, 1 + rng() % (d + 2));
+            }
+        }
+
+        uint64_t hold = pick_duration(hold_th, sizeof(hold_th) / sizeof(hold_th[0]), 1500000);
+        add_edge(w, &t, hold);                                          // Release
+
+        if (rng() % 3 == 0) {
+            int bounces = (int)rng_range(1, 4);
+            for (int b = 0; b < bounces; b++) {
+                add_edge(w, &t, 1 + rng() % (d + 2));
+                add_edge(w, &t, 1 + rng() % (d + 2));
+            }
+        }
+    }
+
+    // Every press adds an even number of edges, so the waveform ends released.
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Reference model                                                           */
+/* -------------------------------------------------------------------------- */
+
+static void model_push(sim_event_t *out, size_t *n, uint64_t emit, uint8_t index,
+                       uint8_t id, btn_event_type_t type, uint8_t clicks, uint64_t ts) {
+    if (*n >= SIM_MAX_EVENTS) return;
+    out[(*n)++] = (sim_event_t){
+        .emit_us = emit, .index = index,
+        .evt = { .btn_id = id, .type = type, .clicks = clicks, .timestamp = ts }
+    };
+}
+
+/**
+ * Expected events of one button, in emission order.
+ *
+ * All library thresholds are strict ("> threshold") and timers fire on the
+ * first update after them, so with updates at every deadline a timer set at
+ * t with threshold x fires at exactly t + x + 1.
+ */
+static size_t model_button(const sim_wave_t *w, const sim_thresholds_t *th,
+                           uint8_t index, uint8_t id, sim_event_t *out) {
+    size_t n = 0;
+
+    // 1. Debounce: logical edges
+    uint64_t logical[SIM_MAX_EDGES];
+    size_t   lcount = 0;
+    bool     logic  = false;
+
+    for (size_t k = 0; k < w->count; k++) {
+        bool     level  = !(k & 1);
+        uint64_t commit = w->times[k] + th->debounce_us + 1;
+        uint64_t next   = (k + 1 < w->count) ? w->times[k + 1] : SIM_NEVER;
+
+        if (level != logic && next > commit) {
+            logical[lcount++] = commit;
+            logic = level;
+        }
+    }
+
+    // 2. Press / release / click / long press
+    uint8_t  clicks       = 0;
+    uint64_t last_release = 0;
+
+    for (size_t k = 0; k + 1 < lcount; k += 2) {
+        uint64_t p = logical[k];
+        uint64_t r = logical[k + 1];
+
+#if BUTTONLIB_ENABLE_MULTICLICK
+        if (clicks > 0 && last_release + th->click_timeout_us + 1 < p) {
+            model_push(out, &n, last_release + th->click_timeout_us + 1, index, id,
+                       BTN_EVT_CLICK, clicks, last_release);
+            clicks = 0;
+        }
+#endif
+
+        model_push(out, &n, p, index, id, BTN_EVT_DOWN, 0, p);
+
+#if BUTTONLIB_ENABLE_LONGPRESS
+        uint64_t ls = p + th->long_press_us + 1;
+        if (ls < r) {
+            model_push(out, &n, ls, index, id, BTN_EVT_LONG_START, 0, ls);
+            clicks = 0;     // A long press ends the click series
+
+#if BUTTONLIB_ENABLE_REPEAT
+            if (th->repeat_period_us > 0) {
+                uint32_t k_rep = 1;
+                for (uint64_t t = ls + th->repeat_period_us + 1; t < r;
+                     t += th->repeat_period_us + 1) {
+                    model_push(out, &n, t, index, id, BTN_EVT_LONG_HOLD,
+                               (uint8_t)(k_rep < 0xFF ? k_rep : 0xFF), t);
+                    k_rep++;
+                }
+            }
+#endif
+        }
+        bool short_press = (r - p) < th->long_press_us;
+#else
+        bool short_press = true;
+#endif
+
+        model_push(out, &n, r, index, id, BTN_EVT_UP, 0, r);
+
+        if (short_press) {
+#if BUTTONLIB_ENABLE_MULTICLICK
+            clicks++;
+            last_release = r;
+#else
+            model_push(out, &n, r, index, id, BTN_EVT_CLICK, 1, r);
+#endif
+        } else {
+            clicks = 0;
+        }
+    }
+
+#if BUTTONLIB_ENABLE_MULTICLICK
+    if (clicks > 0) {
+        model_push(out, &n, last_release + th->click_timeout_us + 1, index, id,
+                   BTN_EVT_CLICK, clicks, last_release);
+    }
+#else
+    (void)clicks;
+    (void)last_release;
+#endif
+
+    return n;
+}
+
+/** Merge per-button streams by (emit time, button index). */
+static size_t model_merge(sim_event_t lists[][SIM_MAX_EVENTS], const size_t *counts,
+                          size_t buttons, sim_event_t *out) {
+    size_t pos[SIM_MAX_BUTTONS] = { 0 };
+    size_t n = 0;
+
+    for (;;) {
+        int best = -1;
+        for (size_t b = 0; b < buttons; b++) {
+            if (pos[b] >= counts[b]) continue;
+            if (best < 0 || lists[b][pos[b]].emit_us < lists[best][pos[best]].emit_us) {
+                best = (int)b;
+            }
+        }
+        if (best < 0) return n;
+        if (n < SIM_MAX_EVENTS) out[n++] = lists[best][pos[best]];
+        pos[best]++;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Library run                                                               */
+/* -------------------------------------------------------------------------- */
+
+static sim_wave_t waves[SIM_MAX_BUTTONS];
+
+static bool sim_read_fn(void *arg) {
+    return ((const sim_wave_t *)arg)->level;
+}
+
+typedef struct {
+    uint64_t scripts;
+    uint64_t buttons;
+    uint64_t edges;
+    uint64_t events;
+    uint64_t updates;
+    uint64_t virtual_us;
+} sim_totals_t;
+
+static void print_sim_event(const char *label, const sim_event_t *e) {
+    printf("  %s: emit=%llu id=%u type=%d clicks=%u ts=%llu\n", label,
+           (unsigned long long)e->emit_us, e->evt.btn_id, (int)e->evt.type,
+           e->evt.clicks, (unsigned long long)e->evt.timestamp);
+}
+
+/** Run one script; returns false (after printing a report) on a mismatch. */
+static bool run_script(uint64_t script, sim_totals_t *totals) {
+    static btn_config_t   cfgs[SIM_MAX_BUTTONS];
+    static btn_state_t    states[SIM_MAX_BUTTONS];
+    static btn_instance_t buttons[SIM_MAX_BUTTONS];
+    static btn_event_t    queue[64];
+    static sim_event_t    got[SIM_MAX_EVENTS];
+    static sim_event_t    lists[SIM_MAX_BUTTONS][SIM_MAX_EVENTS];
+    static sim_event_t    want[SIM_MAX_EVENTS];
+    size_t                counts[SIM_MAX_BUTTONS];
+    btn_context_t         ctx;
+
+    size_t count = rng_range(1, SIM_MAX_BUTTONS);
+    bool   edge  = rng() & 1;
+
+    btn_init(&ctx, buttons, count, queue, 64);
+    btn_set_edge_mode(&ctx, edge);
+
+    for (size_t b = 0; b < count; b++) {
+        cfgs[b] = (btn_config_t){
+            .id               = (uint8_t)(10 + b),
+            .active_low       = rng() & 1,
+            .read_fn          = sim_read_fn,
+            .hw_arg           = &waves[b],
+            .debounce_ms      = (uint16_t)rng_range(0, 20),
+            .click_timeout_ms = (uint16_t)rng_range(0, 300),
+            .long_press_ms    = (uint16_t)rng_range(0, 800),
+            .repeat_period_ms = (uint16_t)(rng() % 3 ? rng_range(0, 200) : 0),
+        };
+    }
+
+    uint64_t now = SIM_START_US;
+    for (size_t b = 0; b < count; b++) {
+        sim_thresholds_t th = thresholds_of(&cfgs[b]);
+
+        btn_setup(&ctx, (uint8_t)b, &cfgs[b], &states[b]);
+        make_wave(&waves[b], &th, now);
+        waves[b].level = cfgs[b].active_low;    // Released
+        counts[b] = model_button(&waves[b], &th, (uint8_t)b, cfgs[b].id, lists[b]);
+        totals->edges += waves[b].count;
+    }
+
+    btn_update(&ctx, now);
+
+    size_t ngot = 0;
+    for (;;) {
+        uint64_t next = btn_next_deadline(&ctx);
+        for (size_t b = 0; b < count; b++) {
+            if (waves[b].next < waves[b].count && waves[b].times[waves[b].next] < next) {
+                next = waves[b].times[waves[b].next];
+            }
+        }
+        if (next == BTN_NO_DEADLINE) break;
+        now = next;
+
+        for (size_t b = 0; b < count; b++) {
+            sim_wave_t *w = &waves[b];
+            if (w->next < w->count && w->times[w->next] == now) {
+                bool pressed = !(w->next & 1);
+                w->level = pressed != cfgs[b].active_low;   // Electrical level
+                w->next++;
+                if (edge) btn_notify_edge(&ctx, cfgs[b].id, now);
+            }
+        }
+
+        btn_update(&ctx, now);
+        totals->updates++;
+
+        btn_event_t evt;
+        while (btn_pop_event(&ctx, &evt)) {
+            if (ngot < SIM_MAX_EVENTS) {
+                got[ngot++] = (sim_event_t){
+                    .emit_us = now,
+                    .index = (uint8_t)(evt.btn_id - 10),
+                    .evt = evt
+                };
+            }
+        }
+    }
+
+    size_t nwant = model_merge(lists, counts, count, want);
+
+    totals->scripts++;
+    totals->buttons += count;
+    totals->events  += ngot;
+    totals->virtual_us += now - SIM_START_US;
+
+    size_t i = 0;
+    while (i < ngot && i < nwant &&
+           got[i].emit_us == want[i].emit_us &&
+           got[i].evt.btn_id == want[i].evt.btn_id &&
+           got[i].evt.type == want[i].evt.type &&
+           got[i].evt.clicks == want[i].evt.clicks &&
+           got[i].evt.timestamp == want[i].evt.timestamp) {
+        i++;
+    }
+    if (i == ngot && i == nwant) return true;
+
+    printf("MISMATCH in script %llu at event %u (library %u events, model %u)\n",
+           (unsigned long long)script, (unsigned)i, (unsigned)ngot, (unsigned)nwant);
+    for (size_t b = 0; b < count; b++) {
+        printf("  button %u: debounce=%u click=%u long=%u repeat=%u low=%d edges:",
+               (unsigned)b, cfgs[b].debounce_ms, cfgs[b].click_timeout_ms,
+               cfgs[b].long_press_ms, cfgs[b].repeat_period_ms, cfgs[b].active_low);
+        for (size_t k = 0; k < waves[b].count; k++) {
+            printf(" %llu", (unsigned long long)(waves[b].times[k] - SIM_START_US));
+        }
+        printf("\n");
+    }
+    if (i < ngot)  print_sim_event("library", &got[i]);
+    if (i < nwant) print_sim_event("model  ", &want[i]);
+    return false;
+}
+
+int main(int argc, char **argv) {
+    uint64_t scripts = (argc > 1) ? strtoull(argv[1], NULL, 0) : 20000;
+    uint64_t seed    = (argc > 2) ? strtoull(argv[2], NULL, 0) : 1;
+
+    rng_state = seed ? seed : 1;
+
+    sim_totals_t totals = { 0 };
+    clock_t      t0     = clock();
+
+    for (uint64_t s = 0; s < scripts; s++) {
+        if (!run_script(s, &totals)) {
+            printf("seed=%llu\n", (unsigned long long)seed);
+            return 1;
+        }
+    }
+
+    double cpu_s = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    printf("buttonlib sim: %llu scripts, %llu buttons, %llu edges, %llu events, "
+           "%llu updates, %.1f h virtual time, %.2f s cpu: OK\n",
+           (unsigned long long)totals.scripts, (unsigned long long)totals.buttons,
+           (unsigned long long)totals.edges, (unsigned long long)totals.events,
+           (unsigned long long)totals.updates, totals.virtual_us / 3.6e9, cpu_s);
+    return 0;
+}
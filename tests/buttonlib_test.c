@@ -2,6 +2,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "buttonlib.h"
+#include "buttonlib_expander.h"
+#include "buttonlib_ladder.h"
 
 /*
  * Simple virtual button model for unit testing.
@@ -17,6 +19,66 @@ static bool vbtn_read_fn(void *arg) {
     return vb->level;
 }
 
+/*
+ * Virtual input bank: one word for several buttons (like gpio_get_all()).
+ */
+
+typedef struct {
+    uint32_t levels;
+    uint32_t reads;
+} virtual_bank_t;
+
+static uint32_t vbank_read_fn(void *arg) {
+    virtual_bank_t *vb = (virtual_bank_t*)arg;
+    vb->reads++;
+    return vb->levels;
+}
+
+/*
+ * Virtual diode-less key matrix: keys[r] = pressed columns of row r.
+ * Reading a row also sees the keys of rows that share a pressed column
+ * (one-hop ghosting, enough for rectangle ghosts).
+ */
+
+typedef struct {
+    uint32_t keys[4];
+    uint8_t  rows;
+    uint8_t  driven;
+    uint32_t selects;
+    uint32_t reads;
+} virtual_matrix_t;
+
+static void vmatrix_select_fn(void *arg, uint8_t row) {
+    virtual_matrix_t *vm = (virtual_matrix_t*)arg;
+    vm->driven = row;
+    vm->selects++;
+}
+
+static uint32_t vmatrix_read_fn(void *arg) {
+    virtual_matrix_t *vm = (virtual_matrix_t*)arg;
+    uint32_t cols = vm->keys[vm->driven];
+    vm->reads++;
+
+    for (uint8_t r = 0; r < vm->rows; r++) {
+        if (vm->keys[r] & vm->keys[vm->driven]) {
+            cols |= vm->keys[r];
+        }
+    }
+
+    return ~cols & 0x0Fu; // Columns pulled up, pressed key reads 0
+}
+
+static int check_failures;
+
+/** Assert inside a test; main() exits non-zero if any check failed. */
+#define CHECK(cond)                                                       \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            check_failures++;                                             \
+            printf("CHECK FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                 \
+    } while (0)
+
 static void advance_ms(uint64_t *now_us, uint32_t delta_ms) {
     *now_us += (uint64_t)delta_ms * 1000ULL;
 }
@@ -324,8 +386,10 @@ static void test_suppression(void) {
     advance_ms(&now, 20);
     btn_update(&ctx, now);
 
+#if BUTTONLIB_ENABLE_SUPPRESS
     // Suppress while held (combo-like use-case)
     btn_suppress_events(&ctx, 1);
+#endif
 
     // Keep holding and then release
     advance_ms(&now, 200);
@@ -344,13 +408,1894 @@ static void test_suppression(void) {
            btn_is_pressed(&ctx, 1) ? "true" : "false");
 }
 
+/* -------------------------------------------------------------------------- */
+/*  Test 6: Bank read mode                                                    */
 /* -------------------------------------------------------------------------- */
 
-int main(void) {
-    test_single_click();
-    test_multi_click();
-    test_long_and_hold();
-    test_queue_overflow();
-    test_suppression();
+static void test_bank_read(void) {
+    printf("=== TEST: bank read mode ===\n");
+
+    btn_instance_t buttons[3];
+    btn_state_t    states[3];
+    btn_bank_t     banks[1];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    // Button 1 is active-high on bit 3, button 2 is active-low on bit 7.
+    virtual_bank_t vbank = { .levels = (1u << 7), .reads = 0 };
+
+    const btn_config_t cfg_a = {
+        .id = 1,
+        .active_low = false,
+        .debounce_ms = 10,
+        .click_timeout_ms = 200,
+        .long_press_ms = 500,
+        .repeat_period_ms = 0,
+        .source = BTN_SRC_BANK,
+        .bank = 0,
+        .bank_bit = 3
+    };
+
+    const btn_config_t cfg_b = {
+        .id = 2,
+        .active_low = true,
+        .debounce_ms = 10,
+        .click_timeout_ms = 200,
+        .long_press_ms = 500,
+        .repeat_period_ms = 0,
+        .source = BTN_SRC_BANK,
+        .bank = 0,
+        .bank_bit = 7
+    };
+
+    btn_init(&ctx, buttons, 3, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup_bank(&ctx, 0, vbank_read_fn, &vbank);
+    btn_setup(&ctx, 0, &cfg_a, &states[0]);
+    btn_setup(&ctx, 1, &cfg_b, &states[1]);
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    // Press both: bit 3 goes high, bit 7 goes low (active-low)
+    vbank.levels = (1u << 3);
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+
+    // Release both
+    vbank.levels = (1u << 7);
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+
+    advance_ms(&now, 250);
+    btn_update(&ctx, now);
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+
+    printf("Bank reads: %u (one per update)\n", (unsigned)vbank.reads);
+
+    // A third button on bit 3 is rejected; bit 3 stays with button 1.
+    btn_config_t cfg_dup = cfg_a;
+    cfg_dup.id = 3;
+    btn_setup(&ctx, 2, &cfg_dup, &states[2]);
+    printf("Duplicate bit 3: %s\n", ctx.buttons[2].config ? "accepted" : "rejected");
+    CHECK(ctx.buttons[2].config == NULL);
+    CHECK(banks[0].btn_index[3] == 0);
+
+    // A notified edge without a level change is consumed by the next scan:
+    // a one-sample spike 10 s later is still debounced and yields nothing.
+    btn_notify_edge(&ctx, 1, now);
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+
+    advance_ms(&now, 10000);
+    vbank.levels = (1u << 3) | (1u << 7);
+    btn_update(&ctx, now);
+    advance_ms(&now, 1);
+    vbank.levels = (1u << 7);
+    btn_update(&ctx, now);
+    advance_ms(&now, 300);
+    btn_update(&ctx, now);
+
+    int spikes = 0;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+        spikes++;
+    }
+    printf("Spike after stale notify: %d events\n", spikes);
+    CHECK(spikes == 0);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 7: Edge-triggered mode with deadline scheduling                      */
+/* -------------------------------------------------------------------------- */
+
+static void print_deadline(uint64_t deadline) {
+    if (deadline == BTN_NO_DEADLINE) {
+        printf("Next deadline: none\n");
+    } else {
+        printf("Next deadline: %llu\n", (unsigned long long)deadline);
+    }
+}
+
+static void test_edge_mode(void) {
+    printf("=== TEST: edge mode + next deadline ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn = { .level = false };
+
+    const btn_config_t cfg = {
+        .id = 1,
+        .active_low = false,
+        .read_fn = vbtn_read_fn,
+        .hw_arg = &vbtn,
+        .callback = NULL,
+        .cb_user_data = NULL,
+        .debounce_ms = 10,
+        .click_timeout_ms = 200,
+        .long_press_ms = 500,
+        .repeat_period_ms = 0
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 16);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+    btn_set_edge_mode(&ctx, true);
+
+    btn_event_t evt;
+
+    print_deadline(btn_next_deadline(&ctx));
+
+    // "IRQ": press edge at 1000 us, main loop wakes up a bit later
+    vbtn.level = true;
+    btn_notify_edge(&ctx, 1, 1000);
+    btn_update(&ctx, 1200);
+    print_deadline(btn_next_deadline(&ctx));
+
+    // Wake exactly at each deadline: DOWN, then release edge
+    btn_update(&ctx, btn_next_deadline(&ctx));
+    vbtn.level = false;
+    btn_notify_edge(&ctx, 1, 100000);
+    btn_update(&ctx, 100000);
+    btn_update(&ctx, btn_next_deadline(&ctx));
+    print_deadline(btn_next_deadline(&ctx));
+
+    // Click timeout
+    btn_update(&ctx, btn_next_deadline(&ctx));
+    print_deadline(btn_next_deadline(&ctx));
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 8: SPSC queue (drop-newest on overflow)                              */
+/* -------------------------------------------------------------------------- */
+
+static void test_queue_spsc(void) {
+    printf("=== TEST: SPSC queue (drop newest) ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_event_t    queue[4]; // power of two, holds 3 events
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn = { .level = false };
+
+    const btn_config_t cfg = {
+        .id = 1,
+        .active_low = false,
+        .read_fn = vbtn_read_fn,
+        .hw_arg = &vbtn,
+        .callback = NULL,
+        .cb_user_data = NULL,
+        .debounce_ms = 1,
+        .click_timeout_ms = 50,
+        .long_press_ms = 1000,
+        .repeat_period_ms = 0
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 4);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+    printf("SPSC enabled: %s\n", btn_set_queue_spsc(&ctx, true) ? "true" : "false");
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    // Three presses -> 6 DOWN/UP events into a 3-slot queue
+    for (int i = 0; i < 3; ++i) {
+        vbtn.level = true;
+        btn_update(&ctx, now);
+        advance_ms(&now, 2);
+        btn_update(&ctx, now);
+        vbtn.level = false;
+        btn_update(&ctx, now);
+        advance_ms(&now, 2);
+        btn_update(&ctx, now);
+    }
+
+    printf("Dropped events: %zu\n", btn_get_dropped_events(&ctx));
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 9: ID map and index-based helpers                                    */
+/* -------------------------------------------------------------------------- */
+
+static void test_id_map(void) {
+    printf("=== TEST: id map + index helpers ===\n");
+
+    btn_instance_t buttons[3];
+    btn_state_t    states[3];
+    btn_event_t    queue[16];
+    uint8_t        id_map[BTN_ID_MAP_SIZE];
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn[3] = { { false }, { false }, { false } };
+    btn_config_t  cfg[3];
+
+    for (int i = 0; i < 3; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(10 * (i + 1)),
+            .active_low = false,
+            .read_fn = vbtn_read_fn,
+            .hw_arg = &vbtn[i],
+            .debounce_ms = 10,
+            .click_timeout_ms = 200,
+            .long_press_ms = 500,
+            .repeat_period_ms = 0
+        };
+    }
+
+    btn_init(&ctx, buttons, 3, queue, 16);
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+    btn_set_id_map(&ctx, id_map);           // before and after setup are both fine
+    btn_setup(&ctx, 1, &cfg[1], &states[1]);
+    btn_setup(&ctx, 2, &cfg[2], &states[2]);
+
+    uint64_t now = 0;
+
+    vbtn[2].level = true;
+    btn_update(&ctx, now);
+    advance_ms(&now, 20);
+    btn_update(&ctx, now);
+
+    int idx = btn_find_index(&ctx, 30);
+    printf("Index of id 30: %d, id 99: %d\n", idx, btn_find_index(&ctx, 99));
+    printf("Pressed id 30: %s, idx %d: %s\n",
+           btn_is_pressed(&ctx, 30) ? "true" : "false",
+           idx,
+           btn_is_pressed_idx(&ctx, (size_t)idx) ? "true" : "false");
+
+    advance_ms(&now, 100);
+    printf("Duration idx %d: %llu us\n", idx,
+           (unsigned long long)btn_get_duration_idx(&ctx, (size_t)idx, now));
+
+#if BUTTONLIB_ENABLE_SUPPRESS
+    btn_suppress_events_idx(&ctx, (size_t)idx);
+    printf("Pressed after suppress: %s\n",
+           btn_is_pressed(&ctx, 30) ? "true" : "false");
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 10: Timers across the 32-bit microsecond wrap                        */
+/* -------------------------------------------------------------------------- */
+
+static void test_time_wrap(void) {
+    printf("=== TEST: timers across 2^32 us ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn = { .level = false };
+
+    const btn_config_t cfg = {
+        .id = 1,
+        .active_low = false,
+        .read_fn = vbtn_read_fn,
+        .hw_arg = &vbtn,
+        .callback = NULL,
+        .cb_user_data = NULL,
+        .debounce_ms = 10,
+        .click_timeout_ms = 200,
+        .long_press_ms = 300,
+        .repeat_period_ms = 100
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 16);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+
+    // Start 100 ms before the low 32 bits of the clock wrap.
+    uint64_t now = 0xFFFFFFFFULL - 100000ULL;
+    btn_event_t evt;
+
+    btn_update(&ctx, now);
+    vbtn.level = true;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+
+    // Hold across the wrap: LONG_START + one repeat
+    advance_ms(&now, 310);
+    btn_update(&ctx, now);
+    printf("Duration: %llu us\n",
+           (unsigned long long)btn_get_duration(&ctx, 1, now));
+    advance_ms(&now, 110);
+    btn_update(&ctx, now);
+
+    vbtn.level = false;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+
+    // Short click after the wrap
+    vbtn.level = true;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    vbtn.level = false;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    print_deadline(btn_next_deadline(&ctx));
+    advance_ms(&now, 250);
+    btn_update(&ctx, now);
+
+    // Full times across the 2^32 us boundary (also with compact events).
+    while (btn_pop_event(&ctx, &evt)) {
+        printf("EVT: id=%u type=%d clicks=%u ts=%llu\n",
+               evt.btn_id, (int)evt.type, evt.clicks,
+               (unsigned long long)btn_event_time_us(&evt, now));
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 11: Runtime reconfiguration of timings                               */
+/* -------------------------------------------------------------------------- */
+
+static void test_reconfigure(void) {
+    printf("=== TEST: reconfigure timings at runtime ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn = { .level = false };
+
+    btn_config_t cfg = {
+        .id = 1,
+        .active_low = false,
+        .read_fn = vbtn_read_fn,
+        .hw_arg = &vbtn,
+        .callback = NULL,
+        .cb_user_data = NULL,
+        .debounce_ms = 10,
+        .click_timeout_ms = 200,
+        .long_press_ms = 1000,
+        .repeat_period_ms = 0
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 16);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    vbtn.level = true;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+
+    // While held, shorten long press: LONG_START must follow the new value.
+    advance_ms(&now, 100);
+    btn_update(&ctx, now);
+    cfg.long_press_ms = 300;
+    printf("Reconfigure: %s\n", btn_reconfigure(&ctx, 0, NULL) ? "true" : "false");
+
+    advance_ms(&now, 250);
+    btn_update(&ctx, now);
+
+    vbtn.level = false;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+
+    bool long_start = false;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+        long_start |= evt.type == BTN_EVT_LONG_START;
+    }
+#if BUTTONLIB_ENABLE_LONGPRESS
+    CHECK(long_start);
+#else
+    (void)long_start;
+#endif
+
+    // Rewiring to a bank that does not exist must leave the read_fn button
+    // untouched: bank 0 bit 0 still belongs to button 2, both keep clicking.
+    btn_instance_t buttons2[2];
+    btn_state_t    states2[2];
+    btn_bank_t     banks[1];
+    virtual_bank_t vbank = { .levels = 0 };
+
+    static btn_config_t cfg_bank, cfg_bad;
+    cfg_bank = cfg;
+    cfg_bank.id = 2;
+    cfg_bank.read_fn = NULL;
+    cfg_bank.source = BTN_SRC_BANK;
+    cfg_bank.bank = 0;
+    cfg_bank.bank_bit = 0;
+
+    btn_init(&ctx, buttons2, 2, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup_bank(&ctx, 0, vbank_read_fn, &vbank);
+    btn_setup(&ctx, 0, &cfg, &states2[0]);
+    btn_setup(&ctx, 1, &cfg_bank, &states2[1]);
+
+    cfg_bad = cfg;
+    cfg_bad.source = BTN_SRC_BANK;
+    cfg_bad.bank = 3;
+    bool ok = btn_reconfigure(&ctx, 0, &cfg_bad);
+    printf("Reconfigure to bank 3: %s, bank 0 used_mask=0x%lx\n",
+           ok ? "true" : "false", (unsigned long)banks[0].used_mask);
+    CHECK(!ok);
+    CHECK(ctx.buttons[0].config == &cfg);
+    CHECK(banks[0].used_mask == 0x1u && banks[0].btn_index[0] == 1);
+
+    now = 0;
+    for (uint32_t ms = 0; ms <= 600; ms++) {
+        now = (uint64_t)ms * 1000ULL;
+        vbtn.level   = (ms >= 10 && ms < 60);
+        vbank.levels = (ms >= 300 && ms < 350) ? 1u : 0u;
+        btn_update(&ctx, now);
+    }
+
+    int clicks[3] = { 0 };
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+        if (evt.type == BTN_EVT_CLICK && evt.btn_id <= 2) {
+            clicks[evt.btn_id]++;
+        }
+    }
+    CHECK(clicks[1] == 1 && clicks[2] == 1);
+
+    // Re-timing a held bank button keeps its snapshot bit, so a release fed
+    // before any timer is due is still seen as a change.
+    static btn_config_t cfg_slow;
+    cfg_slow = cfg_bank;
+    cfg_slow.long_press_ms = 3000;
+
+    btn_init(&ctx, buttons2, 1, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup(&ctx, 0, &cfg_bank, &states2[0]);
+    btn_feed_bank(&ctx, 0, 1u, 0);
+    btn_feed_bank(&ctx, 0, 1u, 15000);
+    btn_reconfigure(&ctx, 0, &cfg_slow);
+    btn_feed_bank(&ctx, 0, 0u, 100000);
+    btn_feed_bank(&ctx, 0, 0u, 115000);
+    printf("Held bank button after reconfigure + release: %s\n",
+           btn_is_pressed_idx(&ctx, 0) ? "pressed" : "released");
+    CHECK(!btn_is_pressed_idx(&ctx, 0));
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 12: Active set with 64 bank buttons                                  */
+/* -------------------------------------------------------------------------- */
+
+static void test_active_set(void) {
+    printf("=== TEST: active set, 64 bank buttons ===\n");
+
+    btn_instance_t buttons[64];
+    btn_state_t    states[64];
+    btn_config_t   cfg[64];
+    btn_bank_t     banks[2];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    virtual_bank_t vbank[2] = { { 0, 0 }, { 0, 0 } };
+
+    btn_init(&ctx, buttons, 64, queue, 16);
+    btn_init_banks(&ctx, banks, 2);
+    btn_setup_bank(&ctx, 0, vbank_read_fn, &vbank[0]);
+    btn_setup_bank(&ctx, 1, vbank_read_fn, &vbank[1]);
+
+    for (int i = 0; i < 64; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(100 + i),
+            .debounce_ms = 10,
+            .click_timeout_ms = 200,
+            .long_press_ms = 500,
+            .source = BTN_SRC_BANK,
+            .bank = (uint8_t)(i / 32),
+            .bank_bit = (uint8_t)(i % 32)
+        };
+        btn_setup(&ctx, (uint8_t)i, &cfg[i], &states[i]);
+    }
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    btn_update(&ctx, now);
+    printf("Busy after first scan: %08lx %08lx\n",
+           (unsigned long)banks[0].busy_mask, (unsigned long)banks[1].busy_mask);
+
+    // Click button 40 (bank 1, bit 8)
+    vbank[1].levels = (1u << 8);
+    advance_ms(&now, 1);
+    btn_update(&ctx, now);
+    printf("Busy while debouncing: %08lx %08lx\n",
+           (unsigned long)banks[0].busy_mask, (unsigned long)banks[1].busy_mask);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    vbank[1].levels = 0;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    advance_ms(&now, 250);
+    btn_update(&ctx, now);
+    printf("Busy after click: %08lx %08lx\n",
+           (unsigned long)banks[0].busy_mask, (unsigned long)banks[1].busy_mask);
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 13: Batch drain and zero-copy peek/commit                            */
+/* -------------------------------------------------------------------------- */
+
+static void test_batch_drain(void) {
+    printf("=== TEST: batch drain + peek/commit ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_event_t    queue[8];
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn = { .level = false };
+
+    const btn_config_t cfg = {
+        .id = 1,
+        .active_low = false,
+        .read_fn = vbtn_read_fn,
+        .hw_arg = &vbtn,
+        .callback = NULL,
+        .cb_user_data = NULL,
+        .debounce_ms = 1,
+        .click_timeout_ms = 50,
+        .long_press_ms = 1000,
+        .repeat_period_ms = 0
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 8);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+
+    uint64_t now = 0;
+    btn_event_t out[8];
+
+    // 3 DOWN/UP pairs, drain 4 in one call: the ring tail moves to slot 4
+    for (int i = 0; i < 3; ++i) {
+        vbtn.level = true;
+        btn_update(&ctx, now);
+        advance_ms(&now, 2);
+        btn_update(&ctx, now);
+        vbtn.level = false;
+        btn_update(&ctx, now);
+        advance_ms(&now, 2);
+        btn_update(&ctx, now);
+    }
+
+    size_t popped = btn_pop_events(&ctx, out, 4);
+    printf("Batch popped: %zu\n", popped);
+    for (size_t i = 0; i < popped; ++i) {
+        print_event("EVT", &out[i]);
+    }
+
+    // 2 more pairs: 6 events queued, head wraps past the ring end
+    for (int i = 0; i < 2; ++i) {
+        vbtn.level = true;
+        btn_update(&ctx, now);
+        advance_ms(&now, 2);
+        btn_update(&ctx, now);
+        vbtn.level = false;
+        btn_update(&ctx, now);
+        advance_ms(&now, 2);
+        btn_update(&ctx, now);
+    }
+
+    // Two contiguous spans: slots 4..7, then 0..1
+    const btn_event_t *span;
+    size_t n;
+    while ((n = btn_peek_events(&ctx, &span)) > 0) {
+        printf("Peek span: %zu\n", n);
+        for (size_t i = 0; i < n; ++i) {
+            print_event("EVT", &span[i]);
+        }
+        btn_commit_events(&ctx, n);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 14: Deferred callback dispatch                                       */
+/* -------------------------------------------------------------------------- */
+
+static bool consume_clicks_cb(const btn_event_t *evt, void *user_data) {
+    int *calls = (int*)user_data;
+    (*calls)++;
+    print_event("CB", evt);
+    return evt->type == BTN_EVT_CLICK; // consume CLICK, queue the rest
+}
+
+static void test_deferred_dispatch(void) {
+    printf("=== TEST: deferred callback dispatch ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_event_t    queue[16];
+    btn_event_t    pending[8];
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn = { .level = false };
+    int calls = 0;
+
+    const btn_config_t cfg = {
+        .id = 1,
+        .active_low = false,
+        .read_fn = vbtn_read_fn,
+        .hw_arg = &vbtn,
+        .callback = consume_clicks_cb,
+        .cb_user_data = &calls,
+        .debounce_ms = 10,
+        .click_timeout_ms = 200,
+        .long_press_ms = 500,
+        .repeat_period_ms = 0
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 16);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+    btn_set_deferred_dispatch(&ctx, pending, 8);
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    vbtn.level = true;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    vbtn.level = false;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    advance_ms(&now, 250);
+    btn_update(&ctx, now);
+
+    printf("Callbacks before dispatch: %d, queued: %s\n",
+           calls, btn_pop_event(&ctx, &evt) ? "yes" : "no");
+
+    printf("Dispatched: %zu\n", btn_dispatch(&ctx));
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 15: Combo engine                                                     */
+/* -------------------------------------------------------------------------- */
+
+static void test_combo(void) {
+    printf("=== TEST: combo engine ===\n");
+
+    btn_instance_t    buttons[2];
+    btn_state_t       states[2];
+    btn_event_t       queue[16];
+    btn_combo_state_t combo_states[1];
+    btn_context_t     ctx;
+
+    virtual_btn_t vbtn[2] = { { false }, { false } };
+    btn_config_t  cfg[2];
+
+    for (int i = 0; i < 2; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(i + 1),
+            .active_low = false,
+            .read_fn = vbtn_read_fn,
+            .hw_arg = &vbtn[i],
+            .debounce_ms = 10,
+            .click_timeout_ms = 200,
+            .long_press_ms = 2000,
+            .repeat_period_ms = 0
+        };
+    }
+
+    static const btn_combo_t combos[1] = {
+        { .id = 50, .members = (1u << 0) | (1u << 1), .hold_ms = 500, .suppress = true }
+    };
+
+    btn_init(&ctx, buttons, 2, queue, 16);
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+    btn_setup(&ctx, 1, &cfg[1], &states[1]);
+    btn_set_combos(&ctx, combos, combo_states, 1);
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    // Press 1, then 2 a bit later
+    vbtn[0].level = true;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    vbtn[1].level = true;
+    advance_ms(&now, 50);
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    print_deadline(btn_next_deadline(&ctx));
+
+    // Hold the chord past hold_ms: exactly one COMBO, members suppressed
+    for (int i = 0; i < 8; ++i) {
+        advance_ms(&now, 100);
+        btn_update(&ctx, now);
+    }
+
+    vbtn[0].level = false;
+    vbtn[1].level = false;
+    btn_update(&ctx, now);
+    advance_ms(&now, 15);
+    btn_update(&ctx, now);
+    advance_ms(&now, 250);
+    btn_update(&ctx, now);
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 16: Key matrix with ghosting detection                               */
+/* -------------------------------------------------------------------------- */
+
+static void test_matrix(void) {
+    printf("=== TEST: key matrix ===\n");
+
+    btn_instance_t buttons[16];
+    btn_state_t    states[16];
+    btn_bank_t     banks[4];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    virtual_matrix_t vm = { .rows = 4 };
+    btn_matrix_t matrix = {
+        .select_fn = vmatrix_select_fn,
+        .read_fn = vmatrix_read_fn,
+        .arg = &vm,
+        .first_bank = 0,
+        .rows = 4,
+        .col_mask = 0x0Fu,
+        .active_low = true
+    };
+
+    btn_init(&ctx, buttons, 16, queue, 16);
+    btn_init_banks(&ctx, banks, 4);
+    btn_set_matrices(&ctx, &matrix, 1);
+
+    // Key (row r, col c) has ID 10 * r + c
+    static btn_config_t cfg[16];
+    for (uint8_t i = 0; i < 16; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(10 * (i / 4) + i % 4),
+            .debounce_ms = 10,
+            .click_timeout_ms = 200,
+            .long_press_ms = 2000,
+            .repeat_period_ms = 0,
+            .source = BTN_SRC_BANK,
+            .bank = (uint8_t)(i / 4),
+            .bank_bit = (uint8_t)(i % 4)
+        };
+        btn_setup(&ctx, i, &cfg[i], &states[i]);
+    }
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    btn_update(&ctx, now);
+    printf("Selects/reads per scan: %u/%u\n", (unsigned)vm.selects, (unsigned)vm.reads);
+
+    // (0,0) and (0,1) pressed: no ambiguity
+    vm.keys[0] = (1u << 0) | (1u << 1);
+    for (int i = 0; i < 3; ++i) {
+        advance_ms(&now, 10);
+        btn_update(&ctx, now);
+    }
+
+    // (1,0) pressed: ghost at (1,1), rows 0 and 1 become ambiguous
+    vm.keys[1] = (1u << 0);
+    for (int i = 0; i < 3; ++i) {
+        advance_ms(&now, 10);
+        btn_update(&ctx, now);
+    }
+    printf("Ghost rows: 0x%lx scans: %u\n",
+           (unsigned long)matrix.ghost_rows, (unsigned)matrix.ghost_scans);
+
+    // (0,1) released: ambiguity clears, (1,0) registers, (1,1) never does
+    vm.keys[0] = (1u << 0);
+    for (int i = 0; i < 3; ++i) {
+        advance_ms(&now, 10);
+        btn_update(&ctx, now);
+    }
+    printf("Ghost rows: 0x%lx\n", (unsigned long)matrix.ghost_rows);
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 17: Timed samples fed into a bank (PIO / external sampler)           */
+/* -------------------------------------------------------------------------- */
+
+static void test_feed_bank(void) {
+    printf("=== TEST: feed bank ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_bank_t     banks[1];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    const btn_config_t cfg = {
+        .id = 7,
+        .active_low = true,
+        .debounce_ms = 0,           // Glitches already filtered by the sampler
+        .click_timeout_ms = 200,
+        .long_press_ms = 1000,
+        .repeat_period_ms = 0,
+        .source = BTN_SRC_BANK,
+        .bank = 0,
+        .bank_bit = 3
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+
+    btn_event_t evt;
+
+    // Initial mask (released = high), then press at 12.345 ms and release
+    // at 80.5 ms; btn_update() only runs on a coarse 50 ms tick.
+    btn_feed_bank(&ctx, 0, 0xFFu, 0);
+    btn_update(&ctx, 0);
+    btn_feed_bank(&ctx, 0, 0xF7u, 12345);
+    btn_update(&ctx, 50000);
+    btn_feed_bank(&ctx, 0, 0xFFu, 80500);
+    btn_update(&ctx, 100000);
+    btn_update(&ctx, 300000);
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 18: Batch of high-rate samples (DMA ring capture)                    */
+/* -------------------------------------------------------------------------- */
+
+static void test_feed_samples(void) {
+    printf("=== TEST: feed bank samples ===\n");
+
+    btn_instance_t buttons[1];
+    btn_state_t    states[1];
+    btn_bank_t     banks[1];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    const btn_config_t cfg = {
+        .id = 8,
+        .active_low = false,
+        .debounce_ms = 5,
+        .click_timeout_ms = 200,
+        .long_press_ms = 1000,
+        .repeat_period_ms = 0,
+        .source = BTN_SRC_BANK,
+        .bank = 0,
+        .bank_bit = 0
+    };
+
+    btn_init(&ctx, buttons, 1, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup(&ctx, 0, &cfg, &states[0]);
+    btn_update(&ctx, 0);
+
+    // 10 ms at 20 kHz: contact bounces for the first 1 ms, then stays closed
+    static uint32_t samples[200];
+    for (size_t i = 0; i < 200; ++i) {
+        samples[i] = (i < 20) ? (uint32_t)(i & 1u) : 1u;
+    }
+
+    size_t scanned = btn_feed_bank_samples(&ctx, 0, samples, 200, 1000, 50000);
+    btn_update(&ctx, 11000);
+    printf("Scanned: %u of 200\n", (unsigned)scanned);
+
+    // Open again for the next 10 ms (stable), then let the click time out
+    for (size_t i = 0; i < 200; ++i) {
+        samples[i] = 0;
+    }
+    scanned = btn_feed_bank_samples(&ctx, 0, samples, 200, 11000, 50000);
+    btn_update(&ctx, 21000);
+    btn_update(&ctx, 300000);
+    printf("Scanned: %u of 200\n", (unsigned)scanned);
+
+    btn_event_t evt;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 19: Asynchronous expander banks                                      */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Fake non-blocking bus: start_fn only records the transfer, the test
+ * completes it later (as an IRQ would).
+ */
+
+typedef struct {
+    uint16_t pins[2];           // Port levels per chip address 0x20 / 0x21
+    uint32_t starts;
+    bool     active;
+    uint8_t  addr;
+    uint8_t *rx;
+    btn_xfer_done_fn_t done;
+    void    *done_arg;
+} fake_bus_t;
+
+static bool fake_bus_start(void *bus_arg, uint8_t addr,
+                           const uint8_t *tx, size_t tx_len,
+                           uint8_t *rx, size_t rx_len,
+                           btn_xfer_done_fn_t done, void *done_arg) {
+    fake_bus_t *fb = (fake_bus_t*)bus_arg;
+    (void)tx; (void)tx_len; (void)rx_len;
+
+    if (fb->active) return false;
+
+    fb->active   = true;
+    fb->addr     = addr;
+    fb->rx       = rx;
+    fb->done     = done;
+    fb->done_arg = done_arg;
+    fb->starts++;
+    return true;
+}
+
+/** Complete all transfers started so far (chained ones included). */
+static void fake_bus_irq(fake_bus_t *fb) {
+    while (fb->active) {
+        uint16_t v = fb->pins[fb->addr - 0x20];
+        fb->rx[0]  = (uint8_t)(v & 0xFF);
+        fb->rx[1]  = (uint8_t)(v >> 8);
+        fb->active = false;
+        fb->done(fb->done_arg, true);
+    }
+}
+
+static void test_expander(void) {
+    printf("=== TEST: async expanders ===\n");
+
+    btn_instance_t buttons[32];
+    btn_state_t    states[32];
+    btn_bank_t     banks[2];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    fake_bus_t         fb = { .pins = { 0xFFFF, 0xFFFF } };
+    btn_expander_t     exps[2];
+    btn_expander_bus_t bus;
+
+    btn_expander_bus_init(&bus, exps, 2, fake_bus_start, &fb);
+    btn_expander_setup(&bus, 0, BTN_EXP_MCP23017, 0x20, 0xFFFF);
+    btn_expander_setup(&bus, 1, BTN_EXP_PCF8575, 0x21, 0xFFFF);
+
+    btn_init(&ctx, buttons, 32, queue, 16);
+    btn_init_banks(&ctx, banks, 2);
+    btn_setup_bank(&ctx, 0, btn_expander_read, &exps[0]);
+    btn_setup_bank(&ctx, 1, btn_expander_read, &exps[1]);
+
+    // 16 active-low buttons per chip, ID = 100 + index
+    static btn_config_t cfg[32];
+    for (uint8_t i = 0; i < 32; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(100 + i),
+            .active_low = true,
+            .debounce_ms = 10,
+            .click_timeout_ms = 200,
+            .long_press_ms = 1000,
+            .repeat_period_ms = 0,
+            .source = BTN_SRC_BANK,
+            .bank = (uint8_t)(i / 16),
+            .bank_bit = (uint8_t)(i % 16)
+        };
+        btn_setup(&ctx, i, &cfg[i], &states[i]);
+    }
+
+    uint64_t now = 0;
+
+    // Press pin 3 of chip 0x21 (button 19); ten 5 ms ticks, IRQ after each
+    fb.pins[1] = (uint16_t)~(1u << 3);
+    for (int i = 0; i < 10; ++i) {
+        btn_update(&ctx, now);
+        fake_bus_irq(&fb);
+        advance_ms(&now, 5);
+    }
+
+    printf("Bus transfers: %u for 10 ticks x 32 buttons\n", (unsigned)fb.starts);
+    printf("Reads: %u/%u errors: %u\n", (unsigned)exps[0].reads,
+           (unsigned)exps[1].reads, (unsigned)(exps[0].errors + exps[1].errors));
+
+    btn_event_t evt;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 20: Cached per-button deadlines                                      */
+/* -------------------------------------------------------------------------- */
+
+static void test_deadline_cache(void) {
+    printf("=== TEST: deadline cache ===\n");
+
+    btn_instance_t buttons[64];
+    btn_state_t    states[64];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn[64];
+    static btn_config_t cfg[64];
+
+    btn_init(&ctx, buttons, 64, queue, 16);
+    for (uint8_t i = 0; i < 64; ++i) {
+        vbtn[i].level = false;
+        cfg[i] = (btn_config_t){
+            .id = i,
+            .active_low = false,
+            .read_fn = vbtn_read_fn,
+            .hw_arg = &vbtn[i],
+            .debounce_ms = 10,
+            .click_timeout_ms = 200,
+            .long_press_ms = 1000,
+            .repeat_period_ms = 0
+        };
+        btn_setup(&ctx, i, &cfg[i], &states[i]);
+    }
+
+    uint64_t now = 0;
+    btn_event_t evt;
+
+    btn_update(&ctx, now);
+    print_deadline(btn_next_deadline(&ctx));
+
+    // Button 40 pressed at 5 ms: debounce, then long-press deadline
+    advance_ms(&now, 5);
+    vbtn[40].level = true;
+    btn_update(&ctx, now);
+    print_deadline(btn_next_deadline(&ctx));
+    btn_update(&ctx, btn_next_deadline(&ctx));
+    print_deadline(btn_next_deadline(&ctx));
+
+    // Shorter long press: the cached deadline moves earlier at once
+    static btn_config_t cfg_short;
+    cfg_short = cfg[40];
+    cfg_short.long_press_ms = 300;
+    btn_reconfigure(&ctx, 40, &cfg_short);
+    print_deadline(btn_next_deadline(&ctx));
+
+    // A notified edge asks for an immediate update
+    btn_notify_edge(&ctx, 7, 20000);
+    print_deadline(btn_next_deadline(&ctx));
+
+    btn_update(&ctx, 400000);
+    print_deadline(btn_next_deadline(&ctx));
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+
+    // Click released at ~61 ms expires at ~262 ms, while the next press
+    // (raw edge at 255 ms) is still being debounced: two single clicks.
+    btn_init(&ctx, buttons, 1, queue, 16);
+    vbtn[0].level = false;
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+
+    for (uint32_t ms = 0; ms <= 500; ms++) {
+        now = (uint64_t)ms * 1000ULL;
+        vbtn[0].level = (ms < 50) || (ms >= 255 && ms < 300);
+        btn_update(&ctx, now);
+    }
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+
+    // Paths outside btn_update() that move a deadline later must not leave
+    // the old minimum behind: feeding the debounce commit, a longer long
+    // press and a suppressed hold.
+    btn_bank_t banks[1];
+    static btn_config_t cfg_bank;
+    cfg_bank = cfg[0];
+    cfg_bank.read_fn = NULL;
+    cfg_bank.source = BTN_SRC_BANK;
+
+    btn_init(&ctx, buttons, 1, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup(&ctx, 0, &cfg_bank, &states[0]);
+
+    btn_feed_bank(&ctx, 0, 1u, 1000000);
+    btn_feed_bank(&ctx, 0, 1u, 1015000);
+    uint64_t d_feed = btn_next_deadline(&ctx);
+    print_deadline(d_feed);
+
+    static btn_config_t cfg_long;
+    cfg_long = cfg_bank;
+    cfg_long.long_press_ms = 3000;
+    btn_reconfigure(&ctx, 0, &cfg_long);
+    uint64_t d_long = btn_next_deadline(&ctx);
+    print_deadline(d_long);
+
+#if BUTTONLIB_ENABLE_LONGPRESS
+    CHECK(d_feed == 1015000 + 1000000 + 1);
+    CHECK(d_long == 1015000 + 3000000 + 1);
+#endif
+#if BUTTONLIB_ENABLE_SUPPRESS && BUTTONLIB_ENABLE_MULTICLICK
+    // Released with a click series pending; suppression drops the timeout.
+    btn_feed_bank(&ctx, 0, 0u, 1100000);
+    btn_feed_bank(&ctx, 0, 0u, 1115000);
+    print_deadline(btn_next_deadline(&ctx));
+    btn_suppress_events_idx(&ctx, 0);
+    print_deadline(btn_next_deadline(&ctx));
+    CHECK(btn_next_deadline(&ctx) == BTN_NO_DEADLINE);
+#endif
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 21: Static button table                                              */
+/* -------------------------------------------------------------------------- */
+
+static virtual_bank_t table_bank = { .levels = 0xFFFFFFFFu };
+static virtual_btn_t  table_vbtn = { .level = false };
+
+static const btn_config_t tbl_configs[] = {
+    BTN_BANK_BUTTON(10, 0, 16, true, BTN_TIMINGS(10, 200, 800, 0)),
+    BTN_BANK_BUTTON(20, 0, 17, true, BTN_TIMINGS(10, 200, 800, 0)),
+    BTN_READ_BUTTON(30, vbtn_read_fn, &table_vbtn, false, BTN_TIMINGS(10, 200, 800, 0)),
+};
+BTN_TABLE_DEFINE(tbl);
+
+static void test_static_table(void) {
+    printf("=== TEST: static table ===\n");
+
+    btn_bank_t    banks[1];
+    btn_event_t   queue[16];
+    btn_context_t ctx;
+
+    btn_init(&ctx, tbl_buttons, tbl_COUNT, queue, 16);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup_bank(&ctx, 0, vbank_read_fn, &table_bank);
+    bool ok = btn_setup_table(&ctx, tbl_configs, tbl_states, tbl_COUNT);
+
+    printf("Table: ok=%d count=%u used=%08lx polled=%u\n", ok, (unsigned)tbl_COUNT,
+           (unsigned long)banks[0].used_mask, (unsigned)ctx.polled_count);
+
+    uint64_t now = 0;
+    btn_update(&ctx, now);
+
+    table_bank.levels &= ~(1u << 17);   // Button 20 pressed (active low)
+    table_vbtn.level = true;            // Button 30 pressed
+    for (int i = 0; i < 3; ++i) {
+        advance_ms(&now, 10);
+        btn_update(&ctx, now);
+    }
+
+    btn_event_t evt;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+
+    // Applying the table again starts from scratch: no doubled polled slot,
+    // no stale pressed bit, bank bits re-registered.
+    ok = btn_setup_table(&ctx, tbl_configs, tbl_states, tbl_COUNT);
+    printf("Table again: ok=%d used=%08lx polled=%u pressed=%08lx\n", ok,
+           (unsigned long)banks[0].used_mask, (unsigned)ctx.polled_count,
+           (unsigned long)ctx.pressed_mask);
+    CHECK(ok);
+    CHECK(banks[0].used_mask == (3u << 16));
+    CHECK(ctx.polled_count == 1);
+    CHECK(ctx.pressed_mask == 0);
+
+    // Indices are uint8_t: more than 256 entries are rejected.
+    static btn_instance_t many[257];
+    btn_context_t big;
+    btn_init(&big, many, 257, NULL, 0);
+    CHECK(!btn_setup_table(&big, tbl_configs, tbl_states, 257));
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 22: Shards with different rates, merged event stream                */
+/* -------------------------------------------------------------------------- */
+
+static void test_shards(void) {
+    printf("=== TEST: shards ===\n");
+
+    btn_instance_t fast_buttons[1], slow_buttons[1];
+    btn_state_t    fast_states[1], slow_states[1];
+    btn_event_t    fast_queue[8], slow_queue[8];
+    btn_context_t  fast, slow;
+
+    virtual_btn_t fast_btn = { .level = false };
+    virtual_btn_t slow_btn = { .level = false };
+
+    const btn_config_t fast_cfg = {
+        .id = 1, .read_fn = vbtn_read_fn, .hw_arg = &fast_btn,
+        .debounce_ms = 2, .click_timeout_ms = 0, .long_press_ms = 500
+    };
+    const btn_config_t slow_cfg = {
+        .id = 2, .read_fn = vbtn_read_fn, .hw_arg = &slow_btn,
+        .debounce_ms = 10, .click_timeout_ms = 0, .long_press_ms = 500
+    };
+
+    btn_init(&fast, fast_buttons, 1, fast_queue, 8);
+    btn_setup(&fast, 0, &fast_cfg, &fast_states[0]);
+    btn_init(&slow, slow_buttons, 1, slow_queue, 8);
+    btn_setup(&slow, 0, &slow_cfg, &slow_states[0]);
+
+    btn_shard_t shards[2] = {
+        { .ctx = &fast, .period_us = 1000 },    // 1 kHz
+        { .ctx = &slow, .period_us = 20000 },   // 50 Hz
+    };
+    btn_context_t *const merge[2] = { &fast, &slow };
+
+    uint64_t now = 0;
+    uint32_t fast_updates = 0;
+    uint32_t slow_updates = 0;
+
+    // Slow key pressed first, fast key 5 ms later, both released at 60 ms.
+    for (uint32_t ms = 0; ms <= 100; ms++) {
+        now = (uint64_t)ms * 1000ULL;
+        slow_btn.level = (ms >= 1 && ms < 60);
+        fast_btn.level = (ms >= 6 && ms < 60);
+
+        uint64_t fast_next = shards[0].next_us;
+        uint64_t slow_next = shards[1].next_us;
+        btn_update_shards(shards, 2, now);
+        fast_updates += (shards[0].next_us != fast_next);
+        slow_updates += (shards[1].next_us != slow_next);
+    }
+
+    printf("Shards: fast updates=%u slow updates=%u next=%llu\n",
+           (unsigned)fast_updates, (unsigned)slow_updates,
+           (unsigned long long)btn_update_shards(shards, 2, now));
+
+    // Nothing newer than 30 ms yet, then the rest in time order.
+    btn_event_t evt;
+    while (btn_merge_pop(merge, 2, 30000, &evt)) {
+        print_event("EVT <=30ms", &evt);
+    }
+    while (btn_merge_pop(merge, 2, UINT64_MAX, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 23: Runtime statistics                                               */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t fake_clock(void *arg) {
+    uint32_t *t = (uint32_t*)arg;
+    *t += 7;   // Every update "takes" 7 units
+    return *t;
+}
+
+static void test_stats(void) {
+    printf("=== TEST: stats ===\n");
+
+    btn_instance_t buttons[2];
+    btn_state_t    states[2];
+    btn_event_t    queue[8];
+    btn_context_t  ctx;
+    btn_stats_t    stats_block;
+    btn_stats_t    stats;
+    uint32_t       clock_units = 0;
+
+    virtual_btn_t vb[2] = { { .level = false }, { .level = false } };
+
+    btn_config_t cfg[2];
+    for (int i = 0; i < 2; i++) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(1 + i), .read_fn = vbtn_read_fn, .hw_arg = &vb[i],
+            .debounce_ms = 10, .click_timeout_ms = 100, .long_press_ms = 500
+        };
+    }
+
+    btn_init(&ctx, buttons, 2, queue, 8);
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+    btn_setup(&ctx, 1, &cfg[1], &states[1]);
+
+    printf("Stats before enable: %d\n", btn_get_stats(&ctx, &stats));
+    btn_set_stats(&ctx, &stats_block, 5000, fake_clock, &clock_units);
+
+    uint64_t now = 0;
+
+    // 4 ms period, 10 ms debounce: DOWN 12 ms after the raw edge (bucket 2).
+    // Button 1 is seen at 4 ms, button 2 at 12 ms.
+    vb[0].level = true;
+    for (int i = 0; i < 7; i++) {
+        advance_ms(&now, 4);
+        btn_update(&ctx, now);
+        if (i == 1) vb[1].level = true;
+    }
+
+    vb[0].level = false;
+    vb[1].level = false;
+    for (int i = 0; i < 40; i++) {
+        advance_ms(&now, 4);
+        btn_update(&ctx, now);
+    }
+
+    btn_get_stats(&ctx, &stats);
+    printf("Stats: updates=%u max=%u avg=%u high_water=%u\n",
+           (unsigned)stats.updates, (unsigned)stats.update_max,
+           (unsigned)stats.update_avg, (unsigned)stats.queue_high_water);
+    printf("Events: down=%u up=%u click=%u\n",
+           (unsigned)stats.events[BTN_EVT_DOWN], (unsigned)stats.events[BTN_EVT_UP],
+           (unsigned)stats.events[BTN_EVT_CLICK]);
+    printf("Latency: max=%u us, hist=", (unsigned)stats.latency_max_us);
+    for (int i = 0; i < 4; i++) {
+        printf("%u ", (unsigned)stats.latency_hist[i]);
+    }
+    printf("\n");
+
+    // Bouncing press, 1 ms period: latency counts from the first raw edge
+    // (1 ms), not from the last bounce (5 ms); DOWN commits at 16 ms.
+    btn_set_stats(&ctx, &stats_block, 5000, NULL, NULL);
+    uint64_t t0 = now;
+    for (uint32_t ms = 0; ms <= 30; ms++) {
+        now = t0 + (uint64_t)ms * 1000ULL;
+        vb[0].level = (ms >= 1 && ms < 3) || ms >= 5;
+        btn_update(&ctx, now);
+    }
+
+    btn_get_stats(&ctx, &stats);
+    printf("Bounced press latency: %u us\n", (unsigned)stats.latency_max_us);
+    CHECK(stats.latency_max_us == 15000);
+    CHECK(stats.latency_hist[3] == 1);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 24: Trace recording and replay                                       */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+    uint8_t data[256];
+    size_t  len;
+    size_t  flushes;
+} trace_sink_t;
+
+static bool trace_sink_fn(void *arg, const uint8_t *data, size_t len) {
+    trace_sink_t *sink = (trace_sink_t*)arg;
+    if (sink->len + len > sizeof(sink->data)) return false;
+
+    for (size_t i = 0; i < len; i++) {
+        sink->data[sink->len + i] = data[i];
+    }
+    sink->len += len;
+    sink->flushes++;
+    return true;
+}
+
+static size_t drain_events(btn_context_t *ctx, btn_event_t *out, size_t n, size_t max) {
+    btn_event_t evt;
+    while (btn_pop_event(ctx, &evt)) {
+        if (n < max) out[n++] = evt;
+    }
+    return n;
+}
+
+static void test_trace_replay(void) {
+    printf("=== TEST: trace replay ===\n");
+
+    btn_instance_t buttons[2];
+    btn_state_t    states[2];
+    btn_event_t    queue[16];
+    btn_context_t  ctx;
+
+    virtual_btn_t vb[2] = { { .level = false }, { .level = true } };  // Button 2 already pressed
+
+    btn_config_t cfg[2];
+    for (int i = 0; i < 2; i++) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(1 + i), .read_fn = vbtn_read_fn, .hw_arg = &vb[i],
+            .debounce_ms = 10, .click_timeout_ms = 150,
+            .long_press_ms = 400, .repeat_period_ms = 100
+        };
+    }
+
+    btn_init(&ctx, buttons, 2, queue, 16);
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+    btn_setup(&ctx, 1, &cfg[1], &states[1]);
+
+    // Recording starts mid-run, with button 2 held since 5 ms.
+    uint64_t now = 5000;
+    btn_update(&ctx, now);
+
+    uint8_t      buf[16];
+    trace_sink_t sink = { .len = 0 };
+    btn_trace_t  trace;
+    btn_trace_start(&ctx, &trace, buf, sizeof(buf), trace_sink_fn, &sink);
+
+    // Button 1: bouncy double click, then a 700 ms hold. Button 2: released at 300 ms.
+    static const uint16_t b1_edges_ms[] = { 20, 25, 30, 80, 160, 220, 400, 1100 };
+    size_t      e = 0;
+    btn_event_t live[32];
+    size_t      live_n = 0;
+
+    for (uint32_t ms = 10; ms <= 1500; ms += 5) {
+        now = (uint64_t)ms * 1000ULL;
+        if (e < sizeof(b1_edges_ms) / sizeof(b1_edges_ms[0]) && ms == b1_edges_ms[e]) {
+            vb[0].level = !vb[0].level;
+            e++;
+        }
+        if (ms == 300) vb[1].level = false;
+        btn_update(&ctx, now);
+        live_n = drain_events(&ctx, live, live_n, 32);
+    }
+
+    btn_trace_stop(&ctx);
+    btn_trace_flush(&trace);
+    printf("Trace: records=%u bytes=%u flushes=%u dropped=%u, live events=%u\n",
+           (unsigned)trace.records, (unsigned)sink.len, (unsigned)sink.flushes,
+           (unsigned)trace.dropped, (unsigned)live_n);
+
+    // Replay at the recording period and with deadline jumps.
+    for (int mode = 0; mode < 2; mode++) {
+        btn_instance_t r_buttons[2];
+        btn_state_t    r_states[2];
+        btn_event_t    r_queue[16];
+        btn_context_t  r_ctx;
+        btn_replay_t   rp;
+
+        btn_init(&r_ctx, r_buttons, 2, r_queue, 16);
+        btn_setup(&r_ctx, 0, &cfg[0], &r_states[0]);
+        btn_setup(&r_ctx, 1, &cfg[1], &r_states[1]);
+        btn_replay_init(&rp, &r_ctx, sink.data, sink.len);
+
+        btn_event_t replayed[32];
+        size_t      n = 0;
+        size_t      updates = 0;
+        while (btn_replay_step(&r_ctx, &rp, mode == 0 ? 5000 : 0)) {
+            updates++;
+            n = drain_events(&r_ctx, replayed, n, 32);
+        }
+
+        size_t same = 0;
+        for (size_t i = 0; i < n && i < live_n; i++) {
+            if (replayed[i].btn_id == live[i].btn_id && replayed[i].type == live[i].type &&
+                replayed[i].clicks == live[i].clicks &&
+                replayed[i].timestamp == live[i].timestamp) {
+                same++;
+            }
+        }
+
+        printf("Replay %s: updates=%u events=%u identical=%u\n",
+               mode == 0 ? "5ms" : "jump", (unsigned)updates, (unsigned)n, (unsigned)same);
+        if (mode == 1) {
+            for (size_t i = 0; i < n; i++) {
+                print_event("EVT", &replayed[i]);
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 25: Gesture sequences over the event stream                          */
+/* -------------------------------------------------------------------------- */
+
+/** Hold the virtual level for ms milliseconds of 1 ms updates. */
+static void run_level(btn_context_t *ctx, virtual_btn_t *vb, bool level,
+                      uint64_t *now, uint32_t ms) {
+    vb->level = level;
+    for (uint32_t i = 0; i < ms; i++) {
+        advance_ms(now, 1);
+        btn_update(ctx, *now);
+    }
+}
+
+static void tap(btn_context_t *ctx, virtual_btn_t *vb, uint64_t *now) {
+    run_level(ctx, vb, true, now, 40);
+    run_level(ctx, vb, false, now, 60);
+}
+
+static void test_gestures(void) {
+    printf("=== TEST: gesture matcher ===\n");
+
+    btn_instance_t       buttons[2];
+    btn_state_t          states[2];
+    btn_event_t          queue[64];
+    btn_context_t        ctx;
+    btn_gesture_engine_t eng;
+
+    virtual_btn_t vbtn[2] = { { false }, { false } };   // C (id 1), L (id 2)
+    btn_config_t  cfg[2];
+
+    for (int i = 0; i < 2; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(i + 1),
+            .read_fn = vbtn_read_fn,
+            .hw_arg = &vbtn[i],
+            .debounce_ms = 10,
+            .click_timeout_ms = 150,
+            .long_press_ms = 600,
+            .repeat_period_ms = 0
+        };
+    }
+
+    static const btn_gesture_step_t unlock[] = {
+        { 1, BTN_EVT_CLICK, 2 }, { 2, BTN_EVT_LONG_START, 0 }
+    };
+    static const btn_gesture_step_t code[] = {
+        { 2, BTN_EVT_CLICK, 1 }, { 2, BTN_EVT_CLICK, 1 }, { 1, BTN_EVT_CLICK, 1 }
+    };
+    static const btn_gesture_t gestures[] = {
+        { .id = 70, .steps = unlock, .length = 2 },
+        { .id = 71, .steps = code,   .length = 3 },
+    };
+
+    bool ok = btn_gesture_compile(&eng, gestures, 2, 1000);
+    printf("compile=%d states=%u symbols=%u\n", ok, eng.state_count, eng.symbol_count);
+
+    btn_init(&ctx, buttons, 2, queue, 64);
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+    btn_setup(&ctx, 1, &cfg[1], &states[1]);
+    btn_set_gestures(&ctx, &eng);
+
+    uint64_t now = 0;
+
+    // C double click, then L long press: 70
+    tap(&ctx, &vbtn[0], &now);
+    tap(&ctx, &vbtn[0], &now);
+    run_level(&ctx, &vbtn[0], false, &now, 200);
+    run_level(&ctx, &vbtn[1], true, &now, 700);
+    run_level(&ctx, &vbtn[1], false, &now, 200);
+
+    // L, L, L, C: the third L falls back to "L L", then C completes 71
+    for (int i = 0; i < 3; ++i) {
+        tap(&ctx, &vbtn[1], &now);
+        run_level(&ctx, &vbtn[1], false, &now, 200);
+    }
+    tap(&ctx, &vbtn[0], &now);
+    run_level(&ctx, &vbtn[0], false, &now, 200);
+
+    // L, L, pause longer than gap_ms, C: no gesture
+    for (int i = 0; i < 2; ++i) {
+        tap(&ctx, &vbtn[1], &now);
+        run_level(&ctx, &vbtn[1], false, &now, 200);
+    }
+    run_level(&ctx, &vbtn[1], false, &now, 1500);
+    tap(&ctx, &vbtn[0], &now);
+    run_level(&ctx, &vbtn[0], false, &now, 200);
+
+    btn_event_t evt;
+    while (btn_pop_event(&ctx, &evt)) {
+        if (evt.type == BTN_EVT_DOWN || evt.type == BTN_EVT_UP) continue;
+        print_event("EVT", &evt);
+    }
+    printf("dropped=%u\n", (unsigned)btn_get_dropped_events(&ctx));
+
+    // Duplicate sequences and empty gestures are rejected
+    static const btn_gesture_t dup[] = {
+        { .id = 1, .steps = code, .length = 3 },
+        { .id = 2, .steps = code, .length = 3 },
+    };
+    static const btn_gesture_t empty[] = { { .id = 3, .steps = code, .length = 0 } };
+    printf("dup=%d empty=%d\n",
+           btn_gesture_compile(&eng, dup, 2, 0),
+           btn_gesture_compile(&eng, empty, 1, 0));
+
+    // Deferred dispatch: gesture 2 shares its ID with button L, whose
+    // callback must still never see it.
+    static const btn_gesture_t same_id[] = { { .id = 2, .steps = unlock, .length = 1 } };
+    btn_gesture_compile(&eng, same_id, 1, 1000);
+
+    int         calls = 0;
+    btn_event_t pending[16];
+    cfg[1].callback     = consume_clicks_cb;
+    cfg[1].cb_user_data = &calls;
+
+    btn_init(&ctx, buttons, 2, queue, 64);
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+    btn_setup(&ctx, 1, &cfg[1], &states[1]);
+    btn_set_deferred_dispatch(&ctx, pending, 16);
+    btn_set_gestures(&ctx, &eng);
+
+    tap(&ctx, &vbtn[0], &now);
+    tap(&ctx, &vbtn[0], &now);
+    run_level(&ctx, &vbtn[0], false, &now, 200);
+    btn_dispatch(&ctx);
+
+    int same_id_gestures = 0;
+    while (btn_pop_event(&ctx, &evt)) {
+        if (evt.type == BTN_EVT_DOWN || evt.type == BTN_EVT_UP) continue;
+        print_event("EVT", &evt);
+        same_id_gestures += evt.type == BTN_EVT_GESTURE && evt.btn_id == 2;
+    }
+    printf("L callback calls=%d\n", calls);
+    CHECK(calls == 0);
+#if BUTTONLIB_ENABLE_MULTICLICK
+    CHECK(same_id_gestures == 1);
+#else
+    CHECK(same_id_gestures == 0); // No double click, no unlock sequence
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 26: Resistor ladder on one ADC input                                 */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+    uint16_t raw;
+    uint32_t conversions;
+} virtual_adc_t;
+
+static uint16_t vadc_read_fn(void *arg) {
+    virtual_adc_t *adc = (virtual_adc_t*)arg;
+    adc->conversions++;
+    return adc->raw;
+}
+
+static void test_ladder(void) {
+    printf("=== TEST: ADC resistor ladder ===\n");
+
+    // 12-bit ADC, idle = pulled up; the B0+B1 chord has its own level.
+    static const btn_ladder_level_t levels[] = {
+        {  300, 0x1 },
+        {  800, 0x3 },
+        { 1100, 0x2 },
+        { 2000, 0x4 },
+        { 4095, 0x0 },
+    };
+
+    btn_instance_t buttons[3];
+    btn_state_t    states[3];
+    btn_bank_t     banks[1];
+    btn_event_t    queue[32];
+    btn_context_t  ctx;
+    btn_ladder_t   ladder;
+
+    virtual_adc_t adc = { .raw = 4095, .conversions = 0 };
+
+    bool ok = btn_ladder_init(&ladder, levels, 5, 150, vadc_read_fn, &adc);
+    static const btn_ladder_level_t unsorted[] = { { 500, 1 }, { 400, 2 } };
+    printf("init=%d unsorted=%d\n", ok,
+           btn_ladder_init(&(btn_ladder_t){ 0 }, unsorted, 2, 0, NULL, NULL));
+
+    // Nearest level within tolerance; settling readings keep the mask.
+    static const uint16_t probe[] = { 4000, 310, 1450, 560, 1050, 1800, 3100, 3990 };
+    for (size_t i = 0; i < sizeof(probe) / sizeof(probe[0]); i++) {
+        printf("raw=%u mask=0x%x\n", probe[i], (unsigned)btn_ladder_decode(&ladder, probe[i]));
+    }
+    printf("rejected=%u\n", (unsigned)ladder.rejected);
+
+    btn_ladder_init(&ladder, levels, 5, 150, vadc_read_fn, &adc);
+
+    btn_init(&ctx, buttons, 3, queue, 32);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup_bank(&ctx, 0, btn_ladder_read, &ladder);
+    btn_config_t cfg[3];
+    for (int i = 0; i < 3; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(i + 1),
+            .debounce_ms = 10,
+            .click_timeout_ms = 100,
+            .long_press_ms = 500,
+            .source = BTN_SRC_BANK,
+            .bank = 0,
+            .bank_bit = (uint8_t)i
+        };
+        btn_setup(&ctx, (uint8_t)i, &cfg[i], &states[i]);
+    }
+
+    uint64_t now = 0;
+    uint32_t updates = 0;
+
+    // B1 click with a settling reading on each edge, then the B0+B1 chord.
+    static const struct { uint16_t raw; uint32_t ms; } script[] = {
+        { 4095, 10 }, { 2600, 1 }, { 1100, 40 }, { 2600, 1 }, { 4095, 200 },
+        { 800, 40 }, { 4095, 200 },
+    };
+    for (size_t k = 0; k < sizeof(script) / sizeof(script[0]); k++) {
+        adc.raw = script[k].raw;
+        for (uint32_t ms = 0; ms < script[k].ms; ms++) {
+            advance_ms(&now, 1);
+            btn_update(&ctx, now);
+            updates++;
+        }
+    }
+
+    btn_event_t evt;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+    printf("updates=%u conversions=%u\n", (unsigned)updates, (unsigned)adc.conversions);
+
+    // Free-running capture: 10 kHz block fed into a bank without read_fn.
+    static uint16_t block[600];
+    for (size_t i = 0; i < 600; i++) {
+        block[i] = (i >= 100 && i < 400) ? 2010 : 4090;
+    }
+
+    btn_ladder_init(&ladder, levels, 5, 150, NULL, NULL);
+    btn_init(&ctx, buttons, 3, queue, 32);
+    btn_init_banks(&ctx, banks, 1);
+    btn_setup_bank(&ctx, 0, NULL, NULL);
+    const btn_config_t cfg_c = {
+        .id = 3, .debounce_ms = 10, .click_timeout_ms = 100, .long_press_ms = 500,
+        .source = BTN_SRC_BANK, .bank = 0, .bank_bit = 2
+    };
+    btn_setup(&ctx, 2, &cfg_c, &states[2]);
+
+    btn_ladder_feed_samples(&ladder, &ctx, 0, block, 600, 1000000, 100000);
+    btn_update(&ctx, 1200000);
+
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Test 27: Queue overflow policies and LONG_HOLD coalescing                 */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+    size_t dropped;
+    int    holds;           ///< LONG_HOLD events popped
+    int    last_clicks;     ///< Repeat count of the last LONG_HOLD
+    bool   in_order;        ///< LONG_HOLD repeat counts were 1, 2, 3, ...
+    bool   released;        ///< UP of button 2 survived
+} overflow_result_t;
+
+static overflow_result_t run_overflow_policy(btn_overflow_policy_t policy, bool coalesce,
+                                             size_t queue_size) {
+    btn_instance_t buttons[2];
+    btn_state_t    states[2];
+    btn_event_t    queue[16];   // queue_size - 1 usable slots
+    btn_context_t  ctx;
+
+    virtual_btn_t vbtn[2] = { { false }, { false } };
+    btn_config_t  cfg[2];
+
+    for (int i = 0; i < 2; ++i) {
+        cfg[i] = (btn_config_t){
+            .id = (uint8_t)(i + 1),
+            .read_fn = vbtn_read_fn,
+            .hw_arg = &vbtn[i],
+            .debounce_ms = 10,
+            .click_timeout_ms = 100,
+            .long_press_ms = 300,
+            .repeat_period_ms = 50
+        };
+    }
+
+    btn_init(&ctx, buttons, 2, queue, queue_size);
+    btn_setup(&ctx, 0, &cfg[0], &states[0]);
+    btn_setup(&ctx, 1, &cfg[1], &states[1]);
+    btn_set_overflow_policy(&ctx, policy, coalesce);
+
+    // Click on 1, then hold 2 for 6 repeats: 6 key events + 6 repeats.
+    uint64_t now = 0;
+    run_level(&ctx, &vbtn[0], true, &now, 30);
+    run_level(&ctx, &vbtn[0], false, &now, 150);
+    run_level(&ctx, &vbtn[1], true, &now, 620);
+    run_level(&ctx, &vbtn[1], false, &now, 150);
+
+    overflow_result_t r = { .dropped = btn_get_dropped_events(&ctx), .in_order = true };
+    printf("policy=%d coalesce=%d size=%u dropped=%u\n",
+           (int)policy, coalesce, (unsigned)queue_size, (unsigned)r.dropped);
+
+    btn_event_t evt;
+    while (btn_pop_event(&ctx, &evt)) {
+        print_event("EVT", &evt);
+        if (evt.type == BTN_EVT_LONG_HOLD) {
+            r.holds++;
+            r.in_order   &= evt.clicks == r.holds;
+            r.last_clicks = evt.clicks;
+        }
+        r.released |= evt.btn_id == 2 && evt.type == BTN_EVT_UP;
+    }
+
+    return r;
+}
+
+static void test_overflow_policy(void) {
+    printf("=== TEST: overflow policies ===\n");
+
+    run_overflow_policy(BTN_OVERFLOW_DROP_OLDEST, false, 8);
+    run_overflow_policy(BTN_OVERFLOW_DROP_NEWEST, false, 8);
+    overflow_result_t prio = run_overflow_policy(BTN_OVERFLOW_PRIORITY, false, 8);
+    overflow_result_t full = run_overflow_policy(BTN_OVERFLOW_PRIORITY, true, 8);
+
+    // Room for every event: coalescing never rewrites a queued entry.
+    overflow_result_t room = run_overflow_policy(BTN_OVERFLOW_PRIORITY, true, 16);
+
+    // Key events survive the priority policy; the full queue folds the
+    // repeats into one LONG_HOLD carrying the latest count.
+    CHECK(prio.released && full.released && room.released);
+    CHECK(room.dropped == 0);
+#if BUTTONLIB_ENABLE_REPEAT
+    CHECK(full.holds == 1 && full.last_clicks == 6);
+    CHECK(room.holds == 6 && room.in_order);
+#else
+    CHECK(full.holds == 0 && room.holds == 0);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    test_single_click();
+    test_multi_click();
+    test_long_and_hold();
+    test_queue_overflow();
+    test_suppression();
+    test_bank_read();
+    test_edge_mode();
+    test_queue_spsc();
+    test_id_map();
+    test_time_wrap();
+    test_reconfigure();
+    test_active_set();
+    test_batch_drain();
+    test_deferred_dispatch();
+    test_combo();
+    test_matrix();
+    test_feed_bank();
+    test_feed_samples();
+    test_expander();
+    test_deadline_cache();
+    test_static_table();
+    test_shards();
+    test_stats();
+    test_trace_replay();
+    test_gestures();
+    test_ladder();
+    test_overflow_policy();
+
+    if (check_failures) {
+        printf("%d check(s) failed\n", check_failures);
+        return 1;
+    }
     return 0;
 }
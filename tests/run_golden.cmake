@@ -0,0 +1,21 @@
+# Run a test program and compare its stdout with a checked-in golden report.
+#
+#   cmake -DPROGRAM=<exe> -DEXPECTED=<file.expected> -P run_golden.cmake
+#
+# Fails on a non-zero exit code or on any difference. The actual output is
+# left next to the test as <program>.out (diff it against the .expected file,
+# copy it over after an intended change).
+
+execute_process(COMMAND ${PROGRAM} OUTPUT_VARIABLE actual RESULT_VARIABLE rc)
+
+get_filename_component(name ${PROGRAM} NAME_WE)
+file(WRITE ${name}.out "${actual}")
+
+if (NOT rc EQUAL 0)
+    message(FATAL_ERROR "${name} exited with ${rc}, output in ${name}.out")
+endif()
+
+file(READ ${EXPECTED} expected)
+if (NOT actual STREQUAL expected)
+    message(FATAL_ERROR "${name}: output differs from ${EXPECTED}, see ${name}.out")
+endif()